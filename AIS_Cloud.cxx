@@ -7,6 +7,7 @@
 #include <BRep_Builder.hxx>
 #include <V3d_View.hxx>
 #include "ColumnTileLOD.hxx"
+#include <climits>
 
 static const std::vector<Quantity_Color> s_colorList = {
 	Quantity_Color(240 / 255.0, 200 / 255.0, 0 / 255.0, Quantity_TOC_sRGB),	// 默认颜色
@@ -21,6 +22,11 @@ static const std::vector<Quantity_Color> s_colorList = {
 };	// 颜色列表
 static size_t s_colorIdx = 0;	// 颜色索引
 
+// tile 数组用可变属性缓冲：显存里的顶点一直保留，OpenGl 层每帧按当前 VertexNumber 画，
+// 切 LOD 改画的顶点数不触发重传
+static const Graphic3d_ArrayFlags kTileArrayFlags =
+	Graphic3d_ArrayFlags_VertexNormal | Graphic3d_ArrayFlags_AttribsMutable;
+
 IMPLEMENT_STANDARD_RTTIEXT(AIS_Cloud, AIS_InteractiveObject)
 
 AIS_Cloud::AIS_Cloud()
@@ -30,52 +36,111 @@ AIS_Cloud::AIS_Cloud()
 }
 
 void AIS_Cloud::SetDataStore(const std::shared_ptr<CloudDataStore>& store)
+{
+	// 1) ~ 6) 列视图、读缓存或划分 + LOD、myTileSetup.Quantize 时换成量化块，见 BuildCloudTileSet
+	CloudTileSet set;
+	if (store != nullptr)
+		BuildCloudTileSet(*store, myTileSetup, set);
+	SetTileSet(store, std::move(set));
+}
+
+void AIS_Cloud::SetTileSet(const std::shared_ptr<CloudDataStore>& store, CloudTileSet&& set)
 {
 	m_store = store;
-	myTiles.clear();
 	myColumns = {};
+	myTiles.clear();
+	myTilesFromCache = false;
+	myStaleGroups.clear();
+	++myTileEpoch;
 
-	if (m_store == nullptr) {
-		SetToUpdate();
-		return;
+	if (m_store != nullptr)
+	{
+		myColumns = set.Columns;
+		myTiles = std::move(set.Tiles);
+		myTilesFromCache = set.FromCache;
+	}
+
+	// 量化过的 tile 集不再读 store 的坐标列，放掉它们（对 double 存储每点约 48 字节）。
+	// 旧队列里进行中的任务可能还在读这些列（如流式阶段的叶子），先停掉队列等它们做完，要用时再建
+	if (m_store != nullptr && set.Quantized)
+	{
+		myLodQueue.reset();
+		myColumns = {};
+		m_store->ReleaseCoordinates();
 	}
 
-	// 1) 从 CloudDataStore 的 SoA 构建 Column 视图
-	myColumns = BuildCloudColumns(*m_store);
-
-	// 2) 基于 Column 做空间划分（octree / KDtree）
-	TilingStatsColumns stats;
-	CloudTilingColumns::BuildOctree(
-		myColumns,
-		myTiles,
-		stats,
-		myTilingParams);       // LeafMaxPoints / MaxDepth 等参数在 myTilingParams 里
-
-	// 3) 为每个 Tile 构建各级 LOD，并在内部计算每级的 ErrorWorld
-	BuildLODsForTiles(
-		myColumns,
-		myTiles,
-		myMaxLODLevel,         // 比如 2 或 3
-		2.0f);                 // 预留出来的世界误差参数
-
-	// 初始化 LOD 缓存和状态
+	// 旧 tile 集还没做完的懒生成任务作废
+	if (myLodQueue)
+		myLodQueue->Reset(m_store, myColumns);
+
+	// 初始化 GArray 缓存和 LOD 状态
 	for (auto& tile : myTiles)
 	{
-		tile.LodArrays.clear();
-		tile.LodArrays.resize(tile.LODs.size()); // 与 LODs 同步
+		tile.PointArray.Nullify();
+		tile.Group.Nullify();
 		tile.CurrentLOD = 0;     // 默认用 LOD0
 		tile.Visible = false;  // 默认都不可见
 	}
 
-	// 4) 通知 OCCT 重新生成展示
+	// 5) 通知 OCCT 重新生成展示
 	SetToUpdate();	//	存疑，有效果吗？
 }
 
+void AIS_Cloud::SetStreamingStore(const std::shared_ptr<CloudDataStore>& store)
+{
+	CloudTileSet set;
+	if (store != nullptr)
+		set.Columns = BuildCloudColumns(*store);
+	SetTileSet(store, std::move(set));
+}
+
+void AIS_Cloud::AppendTiles(std::vector<ColumnTile>&& tiles)
+{
+	if (m_store == nullptr)
+		return;
+
+	myTiles.reserve(myTiles.size() + tiles.size());
+	for (auto& tile : tiles)
+	{
+		for (auto& lvl : tile.LODs)
+			BindLODColumns(myColumns, lvl);
+
+		tile.PointArray.Nullify();
+		tile.Group.Nullify();
+		tile.CurrentLOD = 0;
+		tile.Visible = false;
+		myTiles.push_back(std::move(tile));
+	}
+	tiles.clear();
+}
+
 void AIS_Cloud::ensureTileGArray_(
 	const ColumnTile& tile,
-	const TileLODLevel& lod,
 	Handle(Graphic3d_ArrayOfPoints)& outArr) const
 {
+	// 量化 tile：块就是 LOD0 点序，整块按轴解码成 float（SSE2）再写入；法向随块解出
+	if (!tile.Quant.Empty())
+	{
+		const std::size_t n = tile.Quant.Size();
+		if (n > (std::size_t)INT_MAX)
+			return;
+
+		std::vector<float> buf(n * 6);
+		float* fx = buf.data();
+		float* fn = fx + n * 3;
+		DecodeTileQuant(tile.Quant, n, fx, fx + n, fx + n * 2, fn, fn + n, fn + n * 2);
+
+		outArr = new Graphic3d_ArrayOfPoints((int)n, kTileArrayFlags);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			outArr->AddVertex(fx[i], fx[n + i], fx[n * 2 + i],
+				fn[i], fn[n + i], fn[n * 2 + i]);
+		}
+		return;
+	}
+
+	// 各级 LOD 是 LOD0 点序的前缀，数组装 LOD0 的全部点
+	const TileLODLevel& lod = tile.LODs.front();
 	const Column3f& pos = lod.Position;
 	const Column3f& ncol = lod.Normal;
 
@@ -85,44 +150,39 @@ void AIS_Cloud::ensureTileGArray_(
 		return;
 	}
 
-	if (outArr.IsNull())
-	{
-		const int N = (int)lod.PointCount;
-		if (N <= 0)
-			return;
-
-		outArr = new Graphic3d_ArrayOfPoints(
-			N, Standard_False, Standard_True);
-	}
-
-	const int* idx = pos.Indices;
-	const bool hasIdx = (idx != nullptr);
+	const std::size_t n = lod.PointCount;
+	if (n == 0 || n > (std::size_t)INT_MAX)
+		return;
 
 	// 全局点数：从 CloudDataStore 拿，更可信
 	const std::size_t globalCount =
 		m_store ? m_store->Size() : pos.Count;
 
-	for (std::size_t i = 0; i < lod.PointCount; ++i)
+	const bool hasNrm = ncol.IsValid();
+
+	// 越界的点下标说明 tile 与 store 不匹配：整个 tile 不建数组，而不是跳过个别点留下没写的顶点
+	for (std::size_t i = 0; i < n; ++i)
+		if (pos.Index(i) >= globalCount)
+			return;
+
+	outArr = new Graphic3d_ArrayOfPoints((int)n, kTileArrayFlags);
+
+	// 顶点缓冲本来就是 float：double / Float32 存储都直接转成 float 写入，
+	// 法向在加载时已归一化，不再经过 gp_Dir
+	// 区间模式（点已按 tile 重排）时 pos.Index(i) 是等步长递增的，整段顺序读列
+	for (std::size_t i = 0; i < n; ++i)
 	{
-		int pid = hasIdx ? idx[i] : (int)i;
-		if (pid < 0 || (std::size_t)pid >= globalCount)
-			continue;
+		const std::size_t pid = pos.Index(i);
 
-		const Standard_Real x = pos.X[pid];
-		const Standard_Real y = pos.Y[pid];
-		const Standard_Real z = pos.Z[pid];
-		gp_Pnt p(x, y, z);
+		Standard_Real x, y, z;
+		pos.Get(pid, x, y, z);
 
-		gp_Dir nrm(0.0, 0.0, 1.0);
-		if (ncol.IsValid() && globalCount > (std::size_t)pid)
-		{
-			const Standard_Real nx = ncol.X[pid];
-			const Standard_Real ny = ncol.Y[pid];
-			const Standard_Real nz = ncol.Z[pid];
-			nrm.SetCoord(nx, ny, nz);
-		}
+		Standard_Real nx = 0.0, ny = 0.0, nz = 1.0;
+		if (hasNrm)
+			ncol.Get(pid, nx, ny, nz);
 
-		outArr->AddVertex(p, nrm);
+		outArr->AddVertex((Standard_ShortReal)x, (Standard_ShortReal)y, (Standard_ShortReal)z,
+			(Standard_ShortReal)nx, (Standard_ShortReal)ny, (Standard_ShortReal)nz);
 	}
 }
 
@@ -155,64 +215,161 @@ void AIS_Cloud::setAspect(Handle(Graphic3d_Group) theGroup)
 }
 
 Handle(Graphic3d_ArrayOfPoints)
-AIS_Cloud::EnsureTileLODArray(ColumnTile& tile, int lodIndex)
+AIS_Cloud::EnsureTileArray(ColumnTile& tile)
 {
-	if (lodIndex < 0 || lodIndex >= (int)tile.LODs.size())
+	if (tile.LODs.empty())
 		return Handle(Graphic3d_ArrayOfPoints)();
 
-	// 与 LODs 数量对齐
-	if (tile.LodArrays.size() != tile.LODs.size())
-		tile.LodArrays.resize(tile.LODs.size());
-
-	Handle(Graphic3d_ArrayOfPoints)& arr = tile.LodArrays[lodIndex];
+	Handle(Graphic3d_ArrayOfPoints)& arr = tile.PointArray;
 	if (!arr.IsNull())
 		return arr; // 已有缓存
 
-	const TileLODLevel& lod = tile.LODs[lodIndex];
-
-	ensureTileGArray_(tile, lod, arr);
+	ensureTileGArray_(tile, arr);
+	tile.PointArrayCount = arr.IsNull() ? 0 : arr->VertexNumber();
 
 	return arr;
 }
 
-void AIS_Cloud::Compute(const Handle(PrsMgr_PresentationManager)& thePM,
-	const Handle(Prs3d_Presentation)& thePrs,
-	const Standard_Integer theMode)
+void AIS_Cloud::UpdateTileGroup(ColumnTile& tile)
 {
-	thePrs->Clear();
+	if (myPrs.IsNull())
+		return;
 
-	Handle(Graphic3d_Group) aGroup = thePrs->NewGroup();
-	setAspect(aGroup);
+	const int lvl = tile.CurrentLOD;
+	if (!tile.Visible || lvl < 0 || lvl >= (int)tile.LODs.size())
+	{
+		// 隐藏：一个顶点都不画，数组和显存留着，再显示时不用重传
+		if (!tile.PointArray.IsNull())
+			tile.PointArray->SetVertexNumber(0);
+		return;
+	}
+
+	Handle(Graphic3d_ArrayOfPoints) arr = EnsureTileArray(tile);
+	if (arr.IsNull())
+		return;
+
+	if (tile.Group.IsNull())
+		tile.Group = myPrs->NewGroup();
+	if (tile.Group->IsEmpty())
+	{
+		// 新数组第一次进 group：包围盒按全部顶点算
+		arr->SetVertexNumber(tile.PointArrayCount);
+		setAspect(tile.Group);
+		tile.Group->AddPrimitiveArray(arr);
+	}
+
+	// 嵌套 LOD：只画数组的前 PointCount 个顶点，其余留在缓冲里供切回更细的级别
+	// 上限是实际写入的顶点数，不是分配的容量
+	const int count = (int)std::min<std::size_t>(tile.LODs[lvl].PointCount,
+		(std::size_t)tile.PointArrayCount);
+	arr->SetVertexNumber(count);
+}
+
+void AIS_Cloud::CommitTileGroups()
+{
+	for (int t : myStaleGroups)
+	{
+		if (t < (int)myTiles.size())
+			UpdateTileGroup(myTiles[t]);
+	}
+	myStaleGroups.clear();
 
-	// 打印可显示的tile数量
+	updateDisplayedCounts_();
+
+	// 只改了画的顶点数，结构本身没变：让 view 知道下一次 Redraw 要重画
+	if (!myView.IsNull())
+		myView->Invalidate();
+}
+
+void AIS_Cloud::updateDisplayedCounts_()
+{
 	int numDisplayedTiles = 0;
 	int numDisplayedPoints = 0;
-
-	int idx = 0;
-	for (auto& tile : myTiles)
+	for (const auto& tile : myTiles)
 	{
-		if (!tile.Visible)
+		if (!tile.Visible || tile.PointArray.IsNull() || tile.Group.IsNull() || tile.Group->IsEmpty())
 			continue;
 
-		int lvl = tile.CurrentLOD;
-		if (lvl < 0 || lvl >= (int)tile.LODs.size())
+		const int count = tile.PointArray->VertexNumber();
+		if (count <= 0)
 			continue;
+		++numDisplayedTiles;
+		numDisplayedPoints += count;
+	}
 
-		Handle(Graphic3d_ArrayOfPoints) arr = EnsureTileLODArray(tile, lvl);
-		if (arr.IsNull())
+	// 记录到成员变量，供 HUD 使用
+	myLastNumDisplayedTiles = numDisplayedTiles;
+	myLastNumDisplayedPoints = numDisplayedPoints;
+}
+
+void AIS_Cloud::RequestTileLODs(int tileIndex)
+{
+	if (m_store == nullptr || tileIndex < 0 || tileIndex >= (int)myTiles.size())
+		return;
+
+	const ColumnTile& tile = myTiles[tileIndex];
+	if (tile.LODs.empty() || (int)tile.LODs.size() >= tile.LODsPlanned)
+		return;
+
+	if (!myLodQueue)
+	{
+		myLodQueue = std::make_unique<TileLODQueue>();
+		myLodQueue->Reset(m_store, myColumns);
+	}
+	myLodQueue->Request(tileIndex, tile);
+}
+
+std::size_t AIS_Cloud::PublishTileLODs(std::vector<int>& tiles)
+{
+	tiles.clear();
+	if (!myLodQueue)
+		return 0;
+
+	std::vector<TileLODQueue::Result> results;
+	myLodQueue->Take(results);
+	for (TileLODQueue::Result& r : results)
+	{
+		if (r.Tile < 0 || r.Tile >= (int)myTiles.size())
 			continue;
 
-		aGroup->AddPrimitiveArray(arr);
+		// 只添了更粗的级别，CurrentLOD 仍然有效；LOD0 点序变了，GArray 作废，显示中的就地重建
+		ColumnTile& tile = myTiles[r.Tile];
+		tile.LODs = std::move(r.Work.LODs);
+		if (!r.Work.Quant.Empty())
+			tile.Quant = std::move(r.Work.Quant);   // 量化 tile：块按新点序重排过，LOD 不绑列
+		else
+		{
+			for (auto& lvl : tile.LODs)
+				BindLODColumns(myColumns, lvl);
+			if (tile.Children.empty() && !tile.RangeIndices)
+				tile.Indices = std::move(r.Work.Indices);
+		}
+		tile.PointArray.Nullify();
+		if (!tile.Group.IsNull())
+			tile.Group->Clear();
+		myStaleGroups.push_back(r.Tile);
+		tiles.push_back(r.Tile);
+	}
+	return tiles.size();
+}
+
+void AIS_Cloud::Compute(const Handle(PrsMgr_PresentationManager)& thePM,
+	const Handle(Prs3d_Presentation)& thePrs,
+	const Standard_Integer theMode)
+{
+	// 整体重建只在第一次显示或换 tile 集时发生；之后切 LOD / 显隐由 UpdateTileGroup 就地改各 tile 的 group
+	thePrs->Clear();
+	myPrs = thePrs;
+	myStaleGroups.clear();
 
-		idx++;
-		numDisplayedPoints += arr->VertexNumber();
+	for (auto& tile : myTiles)
+	{
+		tile.Group.Nullify();
+		UpdateTileGroup(tile);
 
 		// 可选：调试打印
-		// printPrimitive10Pts(arr);
+		// printPrimitive10Pts(tile.PointArray);
 	}
 
-	// 记录到成员变量，供 HUD 使用
-	myLastNumDisplayedTiles = idx;
-	myLastNumDisplayedPoints = numDisplayedPoints;
-
+	updateDisplayedCounts_();
 }
@@ -13,6 +13,8 @@
 #include "CloudColumns.hxx"
 #include "ColumnTile.hxx"
 #include "CloudTilingColumns.hxx"
+#include "CloudTileSet.hxx"
+#include "TileLODQueue.hxx"
 
 DEFINE_STANDARD_HANDLE(AIS_Cloud, AIS_InteractiveObject)
 
@@ -23,9 +25,39 @@ class AIS_Cloud : public AIS_InteractiveObject
 public:
 	AIS_Cloud();
 
-	// õ
+	// õݣͬ tile 㼶͸ LODƻ̣߳
 	void SetDataStore(const std::shared_ptr<CloudDataStore>& store);
 
+	// ӹڱ𴦣 CloudImportJob Ḷ́߳õ tile 㼶ֻʼ
+	// set.Columns ָ store ڴ棻set.Quantized ʱ漴ͷ store  / УCloudDataStore::ReleaseCoordinates
+	void SetTileSet(const std::shared_ptr<CloudDataStore>& store, CloudTileSet&& set);
+
+	// ʽʾȽӹ storeֻͼ tile֮ AppendTiles ½Ҷӣ
+	//  SetTileSet 㼶
+	void SetStreamingStore(const std::shared_ptr<CloudDataStore>& store);
+
+	// ׷ tileCloudTileStream ƳҶӣLOD ͼ°󶨵ͼ
+	//  tile CloudLodController һ Tick Զ tile
+	void AppendTiles(std::vector<ColumnTile>&& tiles);
+
+	// tile 滻SetDataStore / SetTileSet / SetStreamingStoreĴAppendTiles ı
+	unsigned TileEpoch() const { return myTileEpoch; }
+
+	// tile 㼶Ĺ SetDataStore ֮ǰ
+	const CloudTileSetup& TileSetup() const { return myTileSetup; }
+	void SetTileSetup(const CloudTileSetup& setup) { myTileSetup = setup; }
+
+	// tile 㼶 / LOD ·棨.octiles SetDataStore ֮ǰ
+	// ԴļֲһʱֱӶأؽдأpath Ϊû
+	void SetTileCache(const std::wstring& path, const FileStamp& source)
+	{
+		myTileSetup.CachePath = path;
+		myTileSetup.CacheSource = source;
+	}
+
+	// һ SetDataStore Ƿ tile 
+	bool TilesFromCache() const { return myTilesFromCache; }
+
 	// ⲿѵǰ View ע Camera ʹڴС
 	void SetView(const Handle(V3d_View)& theView)
 	{
@@ -37,9 +69,28 @@ public:
 	int LastNumDisplayedTiles()  const { return myLastNumDisplayedTiles; }
 	int LastNumDisplayedPoints() const { return myLastNumDisplayedPoints; }
 
-	// CloudLodController ã֤ĳ tile ĳһ LOD Ѿ GArray 
+	// CloudLodController ã֤ tile Ѿ GArray 棨 LOD0 װȫ㣬 LOD ã
+	//  LOD ؽ飬UpdateTileGroup ֻĻĶ
 	Handle(Graphic3d_ArrayOfPoints)
-		EnsureTileLODArray(ColumnTile& tile, int lodIndex);
+		EnsureTileArray(ColumnTile& tile);
+
+	// CloudLodController ã tile.Visible / CurrentLOD ͵ظ tile ĳפ group
+	//  LODֻ黭Ķչʾش㣻½ʱżӽ groupΨһһϴ
+	// չʾûCompute δãʱʲô Compute ͳһ
+	void UpdateTileGroup(ColumnTile& tile);
+
+	// һ UpdateTileGroup ֮ãؽ LOD ʾ tile  groupˢʾ view һ Redraw ػ
+	void CommitTileGroups();
+
+	// CloudLodController ãtile ȱɵ LODColumnTile::LODsPlannedʱ̨в룻Ŷӵĺ
+	void RequestTileLODs(int tileIndex);
+
+	// CloudLodController ãѺ̨ LOD ԭػ tileGArray  LOD0 ϣػ tile ±
+	// Щ tile  group һ CommitTileGroups ʱʱʾ״̬ؽ
+	std::size_t PublishTileLODs(std::vector<int>& tiles);
+
+	// 󡢻û tile 
+	std::size_t PendingTileLODs() const { return myLodQueue ? myLodQueue->Pending() : 0; }
 
 	const std::vector<ColumnTile>& Tiles() const { return myTiles; }
 	std::vector<ColumnTile>& Tiles() { return myTiles; }
@@ -55,21 +106,25 @@ protected:
 	}
 
 	void ensureTileGArray_(const ColumnTile& tile,
-		const TileLODLevel& lod,
 		Handle(Graphic3d_ArrayOfPoints)& outArr) const;
 
 	void setAspect(Handle(Graphic3d_Group) theGroup);
 
+	void updateDisplayedCounts_();
+
 private:
 	std::shared_ptr<CloudDataStore>  m_store;
 	CloudColumns            myColumns;
 	std::vector<ColumnTile> myTiles;
-	TilingParams            myTilingParams;
-
-	int                     myMaxLODLevel = 2;
+	CloudTileSetup          myTileSetup;      //  / LOD  /  / 
+	bool                    myTilesFromCache = false;
+	unsigned                myTileEpoch = 0;
+	std::unique_ptr<TileLODQueue> myLodQueue;   //  LOD Ḷ́߳һ RequestTileLODs ʱ
 
 	int myLastNumDisplayedTiles = 0;
 	int myLastNumDisplayedPoints = 0;
 
 	Handle(V3d_View)        myView;
+	Handle(Prs3d_Presentation) myPrs;   // һ Compute չʾtile group 
+	std::vector<int>        myStaleGroups;   // PublishTileLODs  group CommitTileGroups ؽ tile
 };
\ No newline at end of file
@@ -2,6 +2,8 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
+#include <cstdint>
 
 enum class AttrSemantic
 {
@@ -13,4 +15,42 @@ enum class AttrSemantic
 	User0,
 	User1,
 	User2,
-};
\ No newline at end of file
+};
+
+// ԵԪ
+enum class AttrType : uint32_t
+{
+	UInt8,
+	UInt16,
+	Float32,
+};
+
+struct AttrLayout
+{
+	AttrType Type = AttrType::Float32;
+	int      Components = 1;
+
+	std::size_t ElemBytes() const
+	{
+		const std::size_t b = Type == AttrType::UInt8 ? 1 : (Type == AttrType::UInt16 ? 2 : 4);
+		return b * (std::size_t)Components;
+	}
+};
+
+// ÿ̶Ľմ洢ͣɫ RGB  8 λǿ 16 λ 8 λû float
+inline AttrLayout AttrLayoutOf(AttrSemantic semantic)
+{
+	switch (semantic) {
+	case AttrSemantic::Color:
+		return { AttrType::UInt8, 3 };
+	case AttrSemantic::Intensity:
+		return { AttrType::UInt16, 1 };
+	case AttrSemantic::Classification:
+		return { AttrType::UInt8, 1 };
+	case AttrSemantic::Position:
+	case AttrSemantic::Normal:
+		return { AttrType::Float32, 3 };
+	default:
+		return { AttrType::Float32, 1 };
+	}
+}
\ No newline at end of file
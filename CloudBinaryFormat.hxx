@@ -0,0 +1,75 @@
+// CloudBinaryFormat.hxx
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// 点云列式二进制缓存（.ocb）的磁盘布局，小端
+//
+//   [CloudBinHeader][CloudBinAttr x AttrCount][pad][X][pad][Y][pad][Z][pad][NX][pad][NY][pad][NZ]
+//   [pad][属性列 0][pad][属性列 1]...
+//
+// 每一列是 Count 个连续的 double（CloudBin_Float32 时为 float，坐标相对 Origin），
+// 属性列是 Count 个按 AttrLayoutOf(语义) 交错存放的紧凑元素；
+// 起始偏移按 kCloudBinAlign 对齐；
+// 文件整体映射后，列指针直接指向映射内存，无需拷贝。
+// 不兼容的布局变更必须提升 kCloudBinVersion。
+
+static const char     kCloudBinMagic[8] = { 'O', 'C', 'L', 'D', 'S', 'O', 'A', '\0' };
+static const uint32_t kCloudBinVersion = 3;
+static const uint64_t kCloudBinAlign = 64;
+
+enum CloudBinFlags : uint32_t
+{
+	CloudBin_HasNormals = 1u << 0,
+	CloudBin_Float32 = 1u << 1,
+};
+
+enum CloudBinColumn : int
+{
+	CloudBinCol_X = 0,
+	CloudBinCol_Y,
+	CloudBinCol_Z,
+	CloudBinCol_NX,
+	CloudBinCol_NY,
+	CloudBinCol_NZ,
+	CloudBinCol_Count
+};
+
+struct CloudBinHeader
+{
+	char     Magic[8];
+	uint32_t Version;
+	uint32_t Flags;                      // CloudBinFlags
+	uint64_t Count;                      // 点数
+	double   BBox[6];                    // xmin ymin zmin xmax ymax zmax
+	uint64_t Offset[CloudBinCol_Count];  // 各列起始字节偏移，0 = 该列不存在
+	uint64_t SourceSize;                 // 源文件大小 / 修改时间，用于判断缓存是否过期（0 = 未记录）
+	int64_t  SourceMTime;
+	double   Origin[3];                  // Float32 列的局部原点，double 列为 0
+	uint32_t AttrCount;                  // 紧随文件头的 CloudBinAttr 个数
+	uint32_t PointOrder;                 // 点序标记（CloudDataStore::PointOrder），旧文件为 0 = 源文件顺序
+};
+
+static_assert(sizeof(CloudBinHeader) == 168, "CloudBinHeader layout changed, bump kCloudBinVersion");
+
+// 一列附加属性；Semantic / Type 存 AttrSemantic / AttrType 的枚举值（枚举顺序即文件格式）
+struct CloudBinAttr
+{
+	uint32_t Semantic;
+	uint32_t Type;
+	uint32_t Components;
+	uint32_t Reserved;
+	uint64_t Offset;                     // 列起始字节偏移
+};
+
+static_assert(sizeof(CloudBinAttr) == 24, "CloudBinAttr layout changed, bump kCloudBinVersion");
+
+inline uint64_t CloudBinElemSize(uint32_t flags)
+{
+	return (flags & CloudBin_Float32) ? sizeof(float) : sizeof(double);
+}
+
+inline uint64_t CloudBinAlignUp(uint64_t v)
+{
+	return (v + kCloudBinAlign - 1) / kCloudBinAlign * kCloudBinAlign;
+}
@@ -9,8 +9,24 @@ struct CloudColumns
 	Column3f Position;
 	Column3f Normal; // Normal.Count==0 ʾûз
 	bool     HasNormal = false;
+
+	// ԣuint8 RGB / uint16 ǿ / uint8 ࣩCount==0 ʾû
+	ColumnAttr Color;
+	ColumnAttr Intensity;
+	ColumnAttr Classification;
 };
 
+//  store ĳа󶨳 dense ͼûиʱ Count = 0
+inline void BindAttrColumn(const CloudDataStore& store, AttrSemantic semantic, ColumnAttr& col)
+{
+	const CloudAttrView v = store.Attribute(semantic);
+	col.Semantic = semantic;
+	col.Layout = v.Layout;
+	col.Data = v.Empty() ? nullptr : v.Data;
+	col.Indices = nullptr;
+	col.Count = v.Empty() ? 0 : v.Size;
+}
+
 //  CloudDataStore ͼ
 inline CloudColumns BuildCloudColumns(const CloudDataStore& store)
 {
@@ -26,6 +42,12 @@ inline CloudColumns BuildCloudColumns(const CloudDataStore& store)
 	cols.Position.X = reinterpret_cast<const Standard_Real*>(soa.X);
 	cols.Position.Y = reinterpret_cast<const Standard_Real*>(soa.Y);
 	cols.Position.Z = reinterpret_cast<const Standard_Real*>(soa.Z);
+	cols.Position.FX = soa.FX;   // Float32 洢X/Y/Z Ϊգ float  + Origin
+	cols.Position.FY = soa.FY;
+	cols.Position.FZ = soa.FZ;
+	cols.Position.Origin[0] = soa.Origin[0];
+	cols.Position.Origin[1] = soa.Origin[1];
+	cols.Position.Origin[2] = soa.Origin[2];
 	cols.Position.Indices = nullptr; // 0..n-1
 	cols.Position.Count = n;
 
@@ -36,6 +58,9 @@ inline CloudColumns BuildCloudColumns(const CloudDataStore& store)
 		cols.Normal.X = reinterpret_cast<const Standard_Real*>(soa.NX);
 		cols.Normal.Y = reinterpret_cast<const Standard_Real*>(soa.NY);
 		cols.Normal.Z = reinterpret_cast<const Standard_Real*>(soa.NZ);
+		cols.Normal.FX = soa.FNX;
+		cols.Normal.FY = soa.FNY;
+		cols.Normal.FZ = soa.FNZ;
 		cols.Normal.Indices = nullptr;
 		cols.Normal.Count = n;
 		cols.HasNormal = true;
@@ -49,5 +74,10 @@ inline CloudColumns BuildCloudColumns(const CloudDataStore& store)
 		cols.HasNormal = false;
 	}
 
+	// 
+	BindAttrColumn(store, AttrSemantic::Color, cols.Color);
+	BindAttrColumn(store, AttrSemantic::Intensity, cols.Intensity);
+	BindAttrColumn(store, AttrSemantic::Classification, cols.Classification);
+
 	return cols;
 }
\ No newline at end of file
@@ -1,26 +1,35 @@
 #include "pch.h"
 #include "CloudDataStore.hxx"
 #include "MappedFile.hxx"
+#include "TxtScan.hxx"
+#include "FastFloat.hxx"
+#include "CloudBinaryFormat.hxx"
 
 #include <charconv>
 #include <cfloat>
+#include <cmath>
 #include <chrono>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 
 using clk = std::chrono::high_resolution_clock;
 
 // ---------- ڲAABB ----------
-// ---------- ڲ AABB ----------
 void CloudDataStore::computeBBox_()
 {
 	BndAll_.SetVoid();
-	if (P_.empty()) return;
-	Standard_Real xmin = P_[0].X(), xmax = xmin;
-	Standard_Real ymin = P_[0].Y(), ymax = ymin;
-	Standard_Real zmin = P_[0].Z(), zmax = zmin;
-	const size_t n = P_.size();
+	const CloudSoAView soa = SoA();
+	const size_t n = soa.Size;
+	if (n == 0) return;
+	Standard_Real xmin, ymin, zmin;
+	soa.Point(0, xmin, ymin, zmin);
+	Standard_Real xmax = xmin, ymax = ymin, zmax = zmin;
 	for (size_t i = 1; i < n; ++i) {
-		const gp_Pnt& p = P_[i];
-		const Standard_Real x = p.X(), y = p.Y(), z = p.Z();
+		Standard_Real x, y, z;
+		soa.Point(i, x, y, z);
 		if (x < xmin) xmin = x; else if (x > xmax) xmax = x;
 		if (y < ymin) ymin = y; else if (y > ymax) ymax = y;
 		if (z < zmin) zmin = z; else if (z > zmax) zmax = z;
@@ -32,102 +41,486 @@ void CloudDataStore::computeBBox_()
 // ---------- SoA ά ----------
 void CloudDataStore::invalidateSoA_()
 {
-	soaDirty_ = true;
-	X_.clear(); Y_.clear(); Z_.clear();
-	NX_.clear(); NY_.clear(); NZ_.clear();
+	releaseMapping_();   // ݱã֮ǰӳĶ
+	ReleaseCompatViews();
+	pointOrder_ = 0;
+	releasedSize_ = 0;
 }
 
-void CloudDataStore::rebuildSoA_() const
+CloudSoAView CloudDataStore::SoA() const
+{
+	if (mapping_)
+		return mappedSoA_;
+
+	CloudSoAView view;
+	if (!X_.empty())
+	{
+		view.X = X_.data();
+		view.Y = Y_.data();
+		view.Z = Z_.data();
+		view.Size = X_.size();
+		if (!NX_.empty())
+		{
+			view.NX = NX_.data();
+			view.NY = NY_.data();
+			view.NZ = NZ_.data();
+		}
+	}
+	else if (!X32_.empty())
+	{
+		view.FX = X32_.data();
+		view.FY = Y32_.data();
+		view.FZ = Z32_.data();
+		view.Origin[0] = origin_[0];
+		view.Origin[1] = origin_[1];
+		view.Origin[2] = origin_[2];
+		view.Size = X32_.size();
+		if (!NX32_.empty())
+		{
+			view.FNX = NX32_.data();
+			view.FNY = NY32_.data();
+			view.FNZ = NZ32_.data();
+		}
+	}
+
+	return view;
+}
+
+// ---------- 洢 ----------
+// ѵǰݣлӳУ precision_ ´һݣɴ洢ͷ
+void CloudDataStore::SetPrecision(CloudPrecision p)
+{
+	if (p == precision_) return;
+	precision_ = p;
+
+	const CloudSoAView soa = SoA();
+	if (soa.Empty() || soa.IsFloat() == (p == CloudPrecision::Float32))
+		return;
+
+	// С뾫޹أתǰȡߣӳеȿתŻ
+	std::vector<AttrBuffer> attrs = takeAttributes_();
+	const uint32_t order = pointOrder_;
+
+	const size_t n = soa.Size;
+	const bool withN = soa.HasNormals();
+	if (p == CloudPrecision::Float32)
+	{
+		// ԭȡ׸Ч㣨ȡıһ
+		Standard_Real o[3] = { 0.0, 0.0, 0.0 };
+		for (size_t i = 0; i < n; ++i)
+		{
+			if (std::isfinite(soa.X[i]) && std::isfinite(soa.Y[i]) && std::isfinite(soa.Z[i]))
+			{
+				o[0] = std::floor(soa.X[i]); o[1] = std::floor(soa.Y[i]); o[2] = std::floor(soa.Z[i]);
+				break;
+			}
+		}
+
+		std::vector<float> x(n), y(n), z(n), nx, ny, nz;
+		for (size_t i = 0; i < n; ++i)
+		{
+			x[i] = (float)(soa.X[i] - o[0]); y[i] = (float)(soa.Y[i] - o[1]); z[i] = (float)(soa.Z[i] - o[2]);
+		}
+		if (withN)
+		{
+			nx.resize(n); ny.resize(n); nz.resize(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				nx[i] = (float)soa.NX[i]; ny[i] = (float)soa.NY[i]; nz[i] = (float)soa.NZ[i];
+			}
+		}
+		const Bnd_Box box = BndAll_;
+		invalidateSoA_();
+		std::vector<Standard_Real>().swap(X_); std::vector<Standard_Real>().swap(Y_); std::vector<Standard_Real>().swap(Z_);
+		std::vector<Standard_Real>().swap(NX_); std::vector<Standard_Real>().swap(NY_); std::vector<Standard_Real>().swap(NZ_);
+		X32_ = std::move(x); Y32_ = std::move(y); Z32_ = std::move(z);
+		NX32_ = std::move(nx); NY32_ = std::move(ny); NZ32_ = std::move(nz);
+		origin_[0] = o[0]; origin_[1] = o[1]; origin_[2] = o[2];
+		BndAll_ = box;
+	}
+	else
+	{
+		std::vector<Standard_Real> x(n), y(n), z(n), nx, ny, nz;
+		for (size_t i = 0; i < n; ++i)
+			soa.Point(i, x[i], y[i], z[i]);
+		if (withN)
+		{
+			nx.resize(n); ny.resize(n); nz.resize(n);
+			for (size_t i = 0; i < n; ++i)
+				soa.Normal(i, nx[i], ny[i], nz[i]);
+		}
+		const Bnd_Box box = BndAll_;
+		adoptColumns_(x, y, z, nx, ny, nz, &box);
+	}
+	attrs_ = std::move(attrs);
+	pointOrder_ = order;
+}
+
+// ----------  ----------
+template <class T>
+static void permuteColumn(const T* src, const std::vector<int>& order, std::vector<T>& dst)
+{
+	dst.resize(order.size());
+	for (size_t i = 0; i < order.size(); ++i)
+		dst[i] = src[order[i]];
+}
+
+// ԣ RGB
+template <class T>
+static void permuteAttr(std::vector<T>& v, const std::vector<int>& order)
+{
+	if (v.empty() || order.empty()) return;
+	const size_t comps = v.size() / order.size();
+	std::vector<T> out(v.size());
+	for (size_t i = 0; i < order.size(); ++i)
+		std::copy_n(v.data() + (size_t)order[i] * comps, comps, out.data() + i * comps);
+	v.swap(out);
+}
+
+bool CloudDataStore::PermutePoints(const std::vector<int>& order)
 {
-	if (!soaDirty_) return;
+	const CloudSoAView soa = SoA();
+	const size_t n = soa.Size;
+	if (n == 0 || order.size() != n) return false;
 
-	const size_t n = P_.size();
-	X_.resize(n);
-	Y_.resize(n);
-	Z_.resize(n);
+	// УУ˳ǣFNV-1aԭ֮0 Դļ˳
+	std::vector<bool> seen(n, false);
+	uint32_t tag = 2166136261u ^ pointOrder_;
 	for (size_t i = 0; i < n; ++i)
 	{
-		const gp_Pnt& p = P_[i];
-		X_[i] = p.X();
-		Y_[i] = p.Y();
-		Z_[i] = p.Z();
+		const int id = order[i];
+		if (id < 0 || (size_t)id >= n || seen[id]) return false;
+		seen[id] = true;
+		tag = (tag ^ (uint32_t)id) * 16777619u;
 	}
+	if (tag == 0) tag = 1;
 
-	if (!N_.empty())
+	std::vector<AttrBuffer> attrs = takeAttributes_();
+	const bool withN = soa.HasNormals();
+	const Bnd_Box box = BndAll_;
+	if (soa.IsFloat())
 	{
-		const size_t m = N_.size();
-		NX_.resize(m);
-		NY_.resize(m);
-		NZ_.resize(m);
-		for (size_t i = 0; i < m; ++i)
+		std::vector<float> x, y, z, nx, ny, nz;
+		permuteColumn(soa.FX, order, x); permuteColumn(soa.FY, order, y); permuteColumn(soa.FZ, order, z);
+		if (withN)
 		{
-			const gp_Dir& d = N_[i];
-			NX_[i] = d.X();
-			NY_[i] = d.Y();
-			NZ_[i] = d.Z();
+			permuteColumn(soa.FNX, order, nx); permuteColumn(soa.FNY, order, ny); permuteColumn(soa.FNZ, order, nz);
 		}
+		const Standard_Real o[3] = { soa.Origin[0], soa.Origin[1], soa.Origin[2] };
+		invalidateSoA_();
+		std::vector<Standard_Real>().swap(X_); std::vector<Standard_Real>().swap(Y_); std::vector<Standard_Real>().swap(Z_);
+		std::vector<Standard_Real>().swap(NX_); std::vector<Standard_Real>().swap(NY_); std::vector<Standard_Real>().swap(NZ_);
+		X32_ = std::move(x); Y32_ = std::move(y); Z32_ = std::move(z);
+		NX32_ = std::move(nx); NY32_ = std::move(ny); NZ32_ = std::move(nz);
+		origin_[0] = o[0]; origin_[1] = o[1]; origin_[2] = o[2];
 	}
 	else
 	{
-		NX_.clear(); NY_.clear(); NZ_.clear();
+		std::vector<Standard_Real> x, y, z, nx, ny, nz;
+		permuteColumn(soa.X, order, x); permuteColumn(soa.Y, order, y); permuteColumn(soa.Z, order, z);
+		if (withN)
+		{
+			permuteColumn(soa.NX, order, nx); permuteColumn(soa.NY, order, ny); permuteColumn(soa.NZ, order, nz);
+		}
+		invalidateSoA_();
+		std::vector<float>().swap(X32_); std::vector<float>().swap(Y32_); std::vector<float>().swap(Z32_);
+		std::vector<float>().swap(NX32_); std::vector<float>().swap(NY32_); std::vector<float>().swap(NZ32_);
+		X_ = std::move(x); Y_ = std::move(y); Z_ = std::move(z);
+		NX_ = std::move(nx); NY_ = std::move(ny); NZ_ = std::move(nz);
 	}
 
-	soaDirty_ = false;
+	for (AttrBuffer& b : attrs)
+	{
+		permuteAttr(b.U8, order);
+		permuteAttr(b.U16, order);
+		permuteAttr(b.F32, order);
+	}
+	attrs_ = std::move(attrs);
+	BndAll_ = box;
+	pointOrder_ = tag;
+	return true;
 }
 
-CloudSoAView CloudDataStore::SoA() const
+// ---------- AoS ͼ ----------
+const std::vector<gp_Pnt>& CloudDataStore::Points() const
 {
-	CloudSoAView view;
-	if (P_.empty())
-		return view;
+	const CloudSoAView soa = SoA();
+	if (P_.size() != soa.Size)
+	{
+		P_.clear();
+		P_.reserve(soa.Size);
+		for (size_t i = 0; i < soa.Size; ++i)
+		{
+			Standard_Real x, y, z;
+			soa.Point(i, x, y, z);
+			P_.emplace_back(x, y, z);
+		}
+	}
+	return P_;
+}
 
-	rebuildSoA_();
+const std::vector<gp_Dir>& CloudDataStore::Normals() const
+{
+	const CloudSoAView soa = SoA();
+	if (soa.HasNormals() && N_.size() != soa.Size)
+	{
+		// ǵλgp_Dir ֻܾ SetCoord ֵٹһһΣĩλв죩
+		N_.assign(soa.Size, gp_Dir());
+		for (size_t i = 0; i < soa.Size; ++i)
+		{
+			Standard_Real x, y, z;
+			soa.Normal(i, x, y, z);
+			N_[i].SetCoord(x, y, z);
+		}
+	}
+	return N_;
+}
 
-	view.X = X_.data();
-	view.Y = Y_.data();
-	view.Z = Z_.data();
-	view.Size = X_.size();
+void CloudDataStore::ReleaseCompatViews() const
+{
+	std::vector<gp_Pnt>().swap(P_);
+	std::vector<gp_Dir>().swap(N_);
+}
+
+// ----------  ----------
+CloudAttrView CloudDataStore::Attribute(AttrSemantic s) const
+{
+	for (const CloudAttrView& v : Attributes())
+		if (v.Semantic == s) return v;
+
+	CloudAttrView none;
+	none.Semantic = s;
+	none.Layout = AttrLayoutOf(s);
+	return none;
+}
 
-	if (!NX_.empty() && NX_.size() == view.Size)
+// ӳеǰ֮õں
+std::vector<CloudAttrView> CloudDataStore::Attributes() const
+{
+	std::vector<CloudAttrView> views = mappedAttrs_;
+	for (const AttrBuffer& b : attrs_)
 	{
-		view.NX = NX_.data();
-		view.NY = NY_.data();
-		view.NZ = NZ_.data();
+		CloudAttrView v;
+		v.Semantic = b.Semantic;
+		v.Layout = AttrLayoutOf(b.Semantic);
+		switch (v.Layout.Type) {
+		case AttrType::UInt8:  v.Data = b.U8.data();  break;
+		case AttrType::UInt16: v.Data = b.U16.data(); break;
+		default:               v.Data = b.F32.data(); break;
+		}
+		v.Size = Size();
+		views.push_back(v);
 	}
+	return views;
+}
 
-	return view;
+template <class T>
+bool CloudDataStore::setAttribute_(AttrSemantic s, std::vector<T>& data, AttrType type)
+{
+	const AttrLayout layout = AttrLayoutOf(s);
+	if (s == AttrSemantic::Position || s == AttrSemantic::Normal) return false;
+	if (layout.Type != type || data.empty() || data.size() != Size() * (size_t)layout.Components) return false;
+
+	auto sameSemantic = [s](const auto& a) { return a.Semantic == s; };
+	mappedAttrs_.erase(std::remove_if(mappedAttrs_.begin(), mappedAttrs_.end(), sameSemantic), mappedAttrs_.end());
+	attrs_.erase(std::remove_if(attrs_.begin(), attrs_.end(), sameSemantic), attrs_.end());
+
+	AttrBuffer b;
+	b.Semantic = s;
+	if constexpr (std::is_same_v<T, uint8_t>)  b.U8.swap(data);
+	if constexpr (std::is_same_v<T, uint16_t>) b.U16.swap(data);
+	if constexpr (std::is_same_v<T, float>)    b.F32.swap(data);
+	attrs_.push_back(std::move(b));
+	return true;
+}
+
+bool CloudDataStore::SetAttribute(AttrSemantic s, std::vector<uint8_t> data)
+{
+	return setAttribute_(s, data, AttrType::UInt8);
+}
+bool CloudDataStore::SetAttribute(AttrSemantic s, std::vector<uint16_t> data)
+{
+	return setAttribute_(s, data, AttrType::UInt16);
+}
+bool CloudDataStore::SetAttribute(AttrSemantic s, std::vector<float> data)
+{
+	return setAttribute_(s, data, AttrType::Float32);
+}
+
+void CloudDataStore::ClearAttributes()
+{
+	std::vector<AttrBuffer>().swap(attrs_);
+	std::vector<CloudAttrView>().swap(mappedAttrs_);
+}
+
+std::vector<CloudDataStore::AttrBuffer> CloudDataStore::takeAttributes_()
+{
+	std::vector<AttrBuffer> out;
+	for (const CloudAttrView& v : mappedAttrs_)
+	{
+		AttrBuffer b;
+		b.Semantic = v.Semantic;
+		const size_t n = v.Size * (size_t)v.Layout.Components;
+		switch (v.Layout.Type) {
+		case AttrType::UInt8:  b.U8.assign(v.As<uint8_t>(), v.As<uint8_t>() + n);    break;
+		case AttrType::UInt16: b.U16.assign(v.As<uint16_t>(), v.As<uint16_t>() + n); break;
+		default:               b.F32.assign(v.As<float>(), v.As<float>() + n);       break;
+		}
+		out.push_back(std::move(b));
+	}
+	for (AttrBuffer& b : attrs_)
+		out.push_back(std::move(b));
+	ClearAttributes();
+	return out;
 }
 
 // ---------- ýӿ ----------
-// ---------- ýӿ ----------
-void CloudDataStore::SetXYZ(std::vector<gp_Pnt> pts)
+void CloudDataStore::adoptColumns_(std::vector<Standard_Real>& x, std::vector<Standard_Real>& y, std::vector<Standard_Real>& z,
+	std::vector<Standard_Real>& nx, std::vector<Standard_Real>& ny, std::vector<Standard_Real>& nz, const Bnd_Box* box)
 {
-	P_ = std::move(pts);
-	N_.clear(); N_.shrink_to_fit();
-	computeBBox_();
 	invalidateSoA_();
+	ClearAttributes();
+	std::vector<float>().swap(X32_); std::vector<float>().swap(Y32_); std::vector<float>().swap(Z32_);
+	std::vector<float>().swap(NX32_); std::vector<float>().swap(NY32_); std::vector<float>().swap(NZ32_);
+
+	const size_t n = std::min({ x.size(), y.size(), z.size() });
+	X_ = std::move(x); X_.resize(n);
+	Y_ = std::move(y); Y_.resize(n);
+	Z_ = std::move(z); Z_.resize(n);
+	if (nx.size() != n || ny.size() != n || nz.size() != n)   // Ȳƥ䣬
+	{
+		nx.clear(); ny.clear(); nz.clear();
+	}
+	NX_ = std::move(nx);
+	NY_ = std::move(ny);
+	NZ_ = std::move(nz);
+	if (!box)
+		computeBBox_();
+	else if (n == 0)
+		BndAll_.SetVoid();
+	else
+		BndAll_ = *box;
+
+	if (precision_ == CloudPrecision::Float32)
+	{
+		precision_ = CloudPrecision::Double;
+		SetPrecision(CloudPrecision::Float32);
+	}
 }
 
-void CloudDataStore::SetXYZN(std::vector<gp_Pnt> pts, std::vector<gp_Dir> nrm)
+void CloudDataStore::SetColumns(std::vector<Standard_Real> x, std::vector<Standard_Real> y, std::vector<Standard_Real> z,
+	std::vector<Standard_Real> nx, std::vector<Standard_Real> ny, std::vector<Standard_Real> nz)
 {
-	if (pts.size() != nrm.size()) { nrm.clear(); nrm.shrink_to_fit(); } // Ȳƥ䣬
-	P_ = std::move(pts);
-	N_ = std::move(nrm);
-	computeBBox_();
-	invalidateSoA_();
+	adoptColumns_(x, y, z, nx, ny, nz, nullptr);
 }
 
-void CloudDataStore::SetXYZAndBBox(std::vector<gp_Pnt> pts,
+// ÷߶ͳƹΧУɨһ
+void CloudDataStore::SetColumnsAndBBox(std::vector<Standard_Real> x, std::vector<Standard_Real> y, std::vector<Standard_Real> z,
+	std::vector<Standard_Real> nx, std::vector<Standard_Real> ny, std::vector<Standard_Real> nz,
 	Standard_Real xmin, Standard_Real xmax,
 	Standard_Real ymin, Standard_Real ymax,
 	Standard_Real zmin, Standard_Real zmax)
 {
-	P_ = std::move(pts);
-	N_.clear(); N_.shrink_to_fit();
+	Bnd_Box box;
+	box.Update(xmin, ymin, zmin);
+	box.Update(xmax, ymax, zmax);
+	adoptColumns_(x, y, z, nx, ny, nz, &box);
+}
+
+void CloudDataStore::SetColumns32AndBBox(const Standard_Real origin[3],
+	std::vector<float> x, std::vector<float> y, std::vector<float> z,
+	std::vector<float> nx, std::vector<float> ny, std::vector<float> nz,
+	Standard_Real xmin, Standard_Real xmax,
+	Standard_Real ymin, Standard_Real ymax,
+	Standard_Real zmin, Standard_Real zmax)
+{
+	invalidateSoA_();
+	ClearAttributes();
+	std::vector<Standard_Real>().swap(X_); std::vector<Standard_Real>().swap(Y_); std::vector<Standard_Real>().swap(Z_);
+	std::vector<Standard_Real>().swap(NX_); std::vector<Standard_Real>().swap(NY_); std::vector<Standard_Real>().swap(NZ_);
+	precision_ = CloudPrecision::Float32;
+
+	const size_t n = std::min({ x.size(), y.size(), z.size() });
+	X32_ = std::move(x); X32_.resize(n);
+	Y32_ = std::move(y); Y32_.resize(n);
+	Z32_ = std::move(z); Z32_.resize(n);
+	if (nx.size() != n || ny.size() != n || nz.size() != n)
+	{
+		nx.clear(); ny.clear(); nz.clear();
+	}
+	NX32_ = std::move(nx);
+	NY32_ = std::move(ny);
+	NZ32_ = std::move(nz);
+	origin_[0] = origin[0]; origin_[1] = origin[1]; origin_[2] = origin[2];
+
 	BndAll_.SetVoid();
+	if (n == 0) return;
 	BndAll_.Update(xmin, ymin, zmin);
 	BndAll_.Update(xmax, ymax, zmax);
+}
+
+void CloudDataStore::ReleaseCoordinates()
+{
+	const size_t n = Size();
+	if (n == 0 || releasedSize_ > 0) return;
+
+	// ӳеȿӳһŵ
+	std::vector<AttrBuffer> attrs = takeAttributes_();
+	const uint32_t order = pointOrder_;
 	invalidateSoA_();
+	std::vector<Standard_Real>().swap(X_); std::vector<Standard_Real>().swap(Y_); std::vector<Standard_Real>().swap(Z_);
+	std::vector<Standard_Real>().swap(NX_); std::vector<Standard_Real>().swap(NY_); std::vector<Standard_Real>().swap(NZ_);
+	std::vector<float>().swap(X32_); std::vector<float>().swap(Y32_); std::vector<float>().swap(Z32_);
+	std::vector<float>().swap(NX32_); std::vector<float>().swap(NY32_); std::vector<float>().swap(NZ32_);
+	releasedSize_ = n;
+	attrs_ = std::move(attrs);
+	pointOrder_ = order;
+}
+
+// AoS -> SoA У߲ͷ룬ֵֻһ
+static void splitAoS(std::vector<gp_Pnt>& pts, std::vector<gp_Dir>& nrm,
+	std::vector<Standard_Real>& x, std::vector<Standard_Real>& y, std::vector<Standard_Real>& z,
+	std::vector<Standard_Real>& nx, std::vector<Standard_Real>& ny, std::vector<Standard_Real>& nz)
+{
+	const size_t n = pts.size();
+	x.resize(n); y.resize(n); z.resize(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		x[i] = pts[i].X(); y[i] = pts[i].Y(); z[i] = pts[i].Z();
+	}
+	std::vector<gp_Pnt>().swap(pts);
+
+	if (nrm.size() == n && n > 0)
+	{
+		nx.resize(n); ny.resize(n); nz.resize(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			nx[i] = nrm[i].X(); ny[i] = nrm[i].Y(); nz[i] = nrm[i].Z();
+		}
+	}
+	std::vector<gp_Dir>().swap(nrm);
+}
+
+void CloudDataStore::SetXYZ(std::vector<gp_Pnt> pts)
+{
+	std::vector<gp_Dir> nrm;
+	SetXYZN(std::move(pts), std::move(nrm));
+}
+
+void CloudDataStore::SetXYZN(std::vector<gp_Pnt> pts, std::vector<gp_Dir> nrm)
+{
+	std::vector<Standard_Real> x, y, z, nx, ny, nz;
+	splitAoS(pts, nrm, x, y, z, nx, ny, nz);
+	SetColumns(std::move(x), std::move(y), std::move(z), std::move(nx), std::move(ny), std::move(nz));
+}
+
+void CloudDataStore::SetXYZAndBBox(std::vector<gp_Pnt> pts,
+	Standard_Real xmin, Standard_Real xmax,
+	Standard_Real ymin, Standard_Real ymax,
+	Standard_Real zmin, Standard_Real zmax)
+{
+	std::vector<gp_Dir> nrm;
+	SetXYZNAndBBox(std::move(pts), std::move(nrm), xmin, xmax, ymin, ymax, zmin, zmax);
 }
 
 void CloudDataStore::SetXYZNAndBBox(std::vector<gp_Pnt> pts, std::vector<gp_Dir> nrm,
@@ -135,27 +528,187 @@ void CloudDataStore::SetXYZNAndBBox(std::vector<gp_Pnt> pts, std::vector<gp_Dir>
 	Standard_Real ymin, Standard_Real ymax,
 	Standard_Real zmin, Standard_Real zmax)
 {
-	if (pts.size() != nrm.size()) { nrm.clear(); nrm.shrink_to_fit(); }
-	P_ = std::move(pts);
-	N_ = std::move(nrm);
-	BndAll_.SetVoid();
-	BndAll_.Update(xmin, ymin, zmin);
-	BndAll_.Update(xmax, ymax, zmax);
-	invalidateSoA_();
+	std::vector<Standard_Real> x, y, z, nx, ny, nz;
+	splitAoS(pts, nrm, x, y, z, nx, ny, nz);
+	SetColumnsAndBBox(std::move(x), std::move(y), std::move(z), std::move(nx), std::move(ny), std::move(nz),
+		xmin, xmax, ymin, ymax, zmin, zmax);
 }
 
 // ---------- ı ----------
-static inline bool parseFloat(const char*& p, const char* end, double& out) {
-	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
-	if (p >= end) return false;
-	auto res = std::from_chars(p, end, out);
-	if (res.ec != std::errc()) return false;
-	p = res.ptr;
-	return true;
+// Float32 ֲԭһȡֵ˻ 0
+static inline double originOf(double v)
+{
+	return std::isfinite(v) ? std::floor(v) : 0.0;
 }
-static inline void skipToEOL(const char*& p, const char* end) {
-	while (p < end && *p != '\n') ++p;
-	if (p < end && *p == '\n') ++p;
+
+// ıֵתԣ벢ضϵ [0, maxV] / NaN  0
+static inline double clampAttr(double v, double maxV)
+{
+	if (!(v > 0.0)) return 0.0;
+	return v >= maxV ? maxV : std::floor(v + 0.5);
+}
+
+// ֱд SoA Уƽ store
+// F32 ʱ갴 (ֵ - O)  floatdouble бΪ
+struct SoAColumns
+{
+	bool F32 = false;
+	Standard_Real O[3] = { 0.0, 0.0, 0.0 };
+
+	std::vector<Standard_Real> X, Y, Z;
+	std::vector<Standard_Real> NX, NY, NZ;   // ޷ʱΪ
+	std::vector<float> FX, FY, FZ;
+	std::vector<float> FNX, FNY, FNZ;
+
+	// ԣTxtAttrColumns ָУδõΪ
+	std::vector<uint8_t>  RGB;
+	std::vector<uint16_t> Intensity;
+	std::vector<uint8_t>  Class;
+
+	size_t Size() const { return F32 ? FX.size() : X.size(); }
+
+	void Point(size_t i, double& x, double& y, double& z) const
+	{
+		if (F32) { x = O[0] + FX[i]; y = O[1] + FY[i]; z = O[2] + FZ[i]; }
+		else     { x = X[i]; y = Y[i]; z = Z[i]; }
+	}
+
+	void Reserve(size_t n, bool withN, const TxtAttrColumns& attr = TxtAttrColumns())
+	{
+		if (F32) {
+			FX.reserve(n); FY.reserve(n); FZ.reserve(n);
+			if (withN) { FNX.reserve(n); FNY.reserve(n); FNZ.reserve(n); }
+		}
+		else {
+			X.reserve(n); Y.reserve(n); Z.reserve(n);
+			if (withN) { NX.reserve(n); NY.reserve(n); NZ.reserve(n); }
+		}
+		if (attr.Color >= 0) RGB.reserve(n * 3);
+		if (attr.Intensity >= 0) Intensity.reserve(n);
+		if (attr.Classification >= 0) Class.reserve(n);
+	}
+
+	void PushPoint(double x, double y, double z)
+	{
+		if (F32) {
+			FX.push_back((float)(x - O[0])); FY.push_back((float)(y - O[1])); FZ.push_back((float)(z - O[2]));
+		}
+		else {
+			X.push_back(x); Y.push_back(y); Z.push_back(z);
+		}
+	}
+
+	//  gp_Dir(gp_Vec) ͬĹһģСĬϷ (0,0,1)
+	void PushNormal(double nx, double ny, double nz)
+	{
+		const double sq = nx * nx + ny * ny + nz * nz;
+		if (sq > 1e-20) {
+			const double d = std::sqrt(sq);
+			pushUnit(nx / d, ny / d, nz / d);
+		}
+		else {
+			pushUnit(0.0, 0.0, 1.0);
+		}
+	}
+
+	// һеĸԣvals Ϊǰ nVals ʱ 0
+	void PushAttrs(const double* vals, int nVals, const TxtAttrColumns& a)
+	{
+		auto at = [&](int c) { return c < nVals ? vals[c] : 0.0; };
+		if (a.Color >= 0) {
+			RGB.push_back((uint8_t)clampAttr(at(a.Color), 255.0));
+			RGB.push_back((uint8_t)clampAttr(at(a.Color + 1), 255.0));
+			RGB.push_back((uint8_t)clampAttr(at(a.Color + 2), 255.0));
+		}
+		if (a.Intensity >= 0)
+			Intensity.push_back((uint16_t)clampAttr(at(a.Intensity), 65535.0));
+		if (a.Classification >= 0)
+			Class.push_back((uint8_t)clampAttr(at(a.Classification), 255.0));
+	}
+
+	void Append(const SoAColumns& o)
+	{
+		auto cat = [](auto& dst, const auto& src) { dst.insert(dst.end(), src.begin(), src.end()); };
+		cat(X, o.X); cat(Y, o.Y); cat(Z, o.Z);
+		cat(NX, o.NX); cat(NY, o.NY); cat(NZ, o.NZ);
+		cat(FX, o.FX); cat(FY, o.FY); cat(FZ, o.FZ);
+		cat(FNX, o.FNX); cat(FNY, o.FNY); cat(FNZ, o.FNZ);
+		cat(RGB, o.RGB); cat(Intensity, o.Intensity); cat(Class, o.Class);
+	}
+
+	void Release()
+	{
+		SoAColumns empty;
+		empty.F32 = F32;
+		std::copy(O, O + 3, empty.O);
+		Swap(empty);
+	}
+
+	void Swap(SoAColumns& o)
+	{
+		std::swap(F32, o.F32);
+		std::swap(O, o.O);
+		X.swap(o.X); Y.swap(o.Y); Z.swap(o.Z);
+		NX.swap(o.NX); NY.swap(o.NY); NZ.swap(o.NZ);
+		FX.swap(o.FX); FY.swap(o.FY); FZ.swap(o.FZ);
+		FNX.swap(o.FNX); FNY.swap(o.FNY); FNZ.swap(o.FNZ);
+		RGB.swap(o.RGB); Intensity.swap(o.Intensity); Class.swap(o.Class);
+	}
+
+	// ƽ storeб move ߣ
+	void MoveTo(CloudDataStore& self,
+		double xmin, double xmax, double ymin, double ymax, double zmin, double zmax)
+	{
+		if (F32)
+			self.SetColumns32AndBBox(O, std::move(FX), std::move(FY), std::move(FZ),
+				std::move(FNX), std::move(FNY), std::move(FNZ),
+				xmin, xmax, ymin, ymax, zmin, zmax);
+		else
+			self.SetColumnsAndBBox(std::move(X), std::move(Y), std::move(Z),
+				std::move(NX), std::move(NY), std::move(NZ),
+				xmin, xmax, ymin, ymax, zmin, zmax);
+
+		if (!RGB.empty()) self.SetAttribute(AttrSemantic::Color, std::move(RGB));
+		if (!Intensity.empty()) self.SetAttribute(AttrSemantic::Intensity, std::move(Intensity));
+		if (!Class.empty()) self.SetAttribute(AttrSemantic::Classification, std::move(Class));
+	}
+
+private:
+	void pushUnit(double nx, double ny, double nz)
+	{
+		if (F32) {
+			FNX.push_back((float)nx); FNY.push_back((float)ny); FNZ.push_back((float)nz);
+		}
+		else {
+			NX.push_back(nx); NY.push_back(ny); NZ.push_back(nz);
+		}
+	}
+};
+
+// 㣺 cols  [from, Size()) ԤƸ sinkһ±
+static size_t feedPreview(const SoAColumns& cols, size_t from, CloudPreviewSink& sink)
+{
+	const size_t stride = sink.Stride();
+	const size_t n = cols.Size();
+	if (from >= n) return from;
+
+	std::vector<double> xyz;
+	xyz.reserve(((n - from) / stride + 1) * 3);
+	size_t i = from;
+	for (; i < n; i += stride) {
+		double p[3];
+		cols.Point(i, p[0], p[1], p[2]);
+		xyz.insert(xyz.end(), p, p + 3);
+	}
+	sink.Append(xyz.data(), xyz.size() / 3);
+	return i;
+}
+
+// β'\n' / '\r' / '\r\n'֮һ
+static inline const char* nextLine(const char* eol, const char* end) {
+	if (eol < end && *eol == '\r') ++eol;
+	if (eol < end && *eol == '\n') ++eol;
+	return eol;
 }
 
 template<typename PathT>
@@ -164,68 +717,89 @@ static bool loadTxtMappedImpl(const PathT& path, CloudDataStore& self,
 	std::optional<int> nxCol,
 	std::optional<int> nyCol,
 	std::optional<int> nzCol,
-	int totalColsPerLine)
+	int totalColsPerLine,
+	const TxtAttrColumns& attrCols,
+	CloudTaskControl* ctl,
+	CloudLoadStats& stats)
 {
+	const auto t0 = clk::now();
+
 	MappedView mv;
 	if (!mapFile(path, mv)) return false;
 
 	const char* ptr = mv.data;
 	const char* end = mv.data + mv.size;
+	TaskBegin(ctl, CloudTaskStage::Parse, mv.size);
+	const char* reported = ptr;
+	const char* stop = TaskCheckpoint(ctl, ptr, end);
 
-	// ͳ reserve
-	size_t nLines = 0;
-	for (const char* q = ptr; q < end; ++q) if (*q == '\n') ++nLines;
-	if (nLines == 0) { mv.close(); return false; }
+	// г reserveļԤɨһ
+	const size_t nLines = TxtScan::EstimateLines(ptr, end);
+	CloudPreviewSink* preview = ctl ? ctl->Preview() : nullptr;
+	size_t previewNext = 0;
+	if (preview) preview->Begin(nLines);
 
 	const bool withN = (nxCol && nyCol && nzCol);
-	std::vector<gp_Pnt> pts; pts.reserve(nLines);
-	std::vector<gp_Dir> nrm; if (withN) nrm.reserve(nLines);
+	const bool withAttr = attrCols.Any();
+	SoAColumns cols;
+	cols.F32 = (self.Precision() == CloudPrecision::Float32);
+	cols.Reserve(nLines, withN, attrCols);
 
 	bool first = true;
 	double xmin = 0, xmax = 0, ymin = 0, ymax = 0, zmin = 0, zmax = 0;
 
-	// ѭ
-	while (ptr < end) {
-		if (*ptr == '\n') { ++ptr; continue; }
+	double vals[32]; // 㹻
+	const int maxCols = std::min(totalColsPerLine, (int)std::size(vals));
+
+	// ѭÿֻɨһ飬ȶλβ [ptr, eol) зֶ
+	for (;;) {
+		if (ptr >= stop) {
+			// 㣺㱨 / Ӧȡ ctl ʱ stop == end
+			if (ptr >= end) break;
+			ctl->Advance((uint64_t)(ptr - reported));
+			reported = ptr;
+			if (ctl->IsCancelled()) { mv.close(); return false; }
+			if (preview) previewNext = feedPreview(cols, previewNext, *preview);
+			stop = TaskCheckpoint(ctl, ptr, end);
+		}
+
 		// UTF-8 BOM
-		if ((unsigned char)ptr[0] == 0xEF && (end - ptr) >= 3 &&
+		if ((end - ptr) >= 3 && (unsigned char)ptr[0] == 0xEF &&
 			(unsigned char)ptr[1] == 0xBB && (unsigned char)ptr[2] == 0xBF) ptr += 3;
 
+		const char* eol = TxtScan::FindEOL(ptr, end);
+
 		// 
-		double vals[32]; // 㹻
 		int colCount = 0; bool ok = true;
-		for (; colCount < totalColsPerLine && ptr < end; ++colCount) {
-			double v;
-			if (!parseFloat(ptr, end, v)) { ok = false; break; }
-			vals[colCount] = v;
-			while (ptr < end && (*ptr == ' ' || *ptr == '\t')) ++ptr;
-			if (ptr < end && (*ptr == '\n' || *ptr == '\r')) {
-				if (*ptr == '\r') { ++ptr; if (ptr < end && *ptr == '\n') ++ptr; }
-				else ++ptr;
-				++colCount; // Ϊн
-				break;
-			}
+		for (const char* q = ptr; colCount < maxCols; ++colCount) {
+			q = TxtScan::SkipBlanks(q, eol);
+			if (q >= eol) break;
+			auto res = FastFloat::Parse(q, eol, vals[colCount]);
+			if (res.ec != std::errc()) { ok = false; break; }
+			q = res.ptr;
 		}
-		// β
-		if (ptr < end && *ptr != '\n') skipToEOL(ptr, end);
+		ptr = nextLine(eol, end);
 		if (!ok) continue;
 		if (colCount <= std::max({ xCol,yCol,zCol })) continue;
 
 		const double x = vals[xCol], y = vals[yCol], z = vals[zCol];
-		pts.emplace_back(x, y, z);
+		if (first && cols.F32) {
+			// ֲԭ㣺׸Чȡ
+			cols.O[0] = originOf(x); cols.O[1] = originOf(y); cols.O[2] = originOf(z);
+		}
+		cols.PushPoint(x, y, z);
 
 		if (withN) {
 			if (colCount <= std::max({ *nxCol,*nyCol,*nzCol })) {
 				// 㣬ĬϷ
-				nrm.emplace_back(0.0, 0.0, 1.0);
+				cols.PushNormal(0.0, 0.0, 1.0);
 			}
 			else {
-				const double nx = vals[*nxCol], ny = vals[*nyCol], nz = vals[*nzCol];
-				gp_Vec v(nx, ny, nz);
-				if (v.SquareMagnitude() > 1e-20) nrm.emplace_back(gp_Dir(v));
-				else nrm.emplace_back(0.0, 0.0, 1.0);
+				cols.PushNormal(vals[*nxCol], vals[*nyCol], vals[*nzCol]);
 			}
 		}
+		if (withAttr)
+			cols.PushAttrs(vals, colCount, attrCols);
 
 		if (first) { xmin = xmax = x; ymin = ymax = y; zmin = zmax = z; first = false; }
 		else {
@@ -235,11 +809,14 @@ static bool loadTxtMappedImpl(const PathT& path, CloudDataStore& self,
 		}
 	}
 
+	TaskAdvance(ctl, (uint64_t)(ptr - reported));
+	stats.Bytes = mv.size;
 	mv.close();
 
-	if (withN) self.SetXYZNAndBBox(std::move(pts), std::move(nrm), xmin, xmax, ymin, ymax, zmin, zmax);
-	else       self.SetXYZAndBBox(std::move(pts), xmin, xmax, ymin, ymax, zmin, zmax);
+	stats.Points = cols.Size();
+	cols.MoveTo(self, xmin, xmax, ymin, ymax, zmin, zmax);
 
+	stats.ParseMs = std::chrono::duration<double, std::milli>(clk::now() - t0).count();
 	return true;
 }
 
@@ -249,9 +826,10 @@ bool CloudDataStore::LoadTxtMapped(const std::wstring& path,
 	std::optional<int> nxCol,
 	std::optional<int> nyCol,
 	std::optional<int> nzCol,
-	int totalColsPerLine)
+	int totalColsPerLine,
+	const TxtAttrColumns& attrCols)
 {
-	return loadTxtMappedImpl(path, *this, xCol, yCol, zCol, nxCol, nyCol, nzCol, totalColsPerLine);
+	return loadTxtMappedImpl(path, *this, xCol, yCol, zCol, nxCol, nyCol, nzCol, totalColsPerLine, attrCols, task_, loadStats_);
 }
 
 bool CloudDataStore::LoadTxtMapped(const std::string& path,
@@ -259,9 +837,10 @@ bool CloudDataStore::LoadTxtMapped(const std::string& path,
 	std::optional<int> nxCol,
 	std::optional<int> nyCol,
 	std::optional<int> nzCol,
-	int totalColsPerLine)
+	int totalColsPerLine,
+	const TxtAttrColumns& attrCols)
 {
-	return loadTxtMappedImpl(path, *this, xCol, yCol, zCol, nxCol, nyCol, nzCol, totalColsPerLine);
+	return loadTxtMappedImpl(path, *this, xCol, yCol, zCol, nxCol, nyCol, nzCol, totalColsPerLine, attrCols, task_, loadStats_);
 }
 
 //  Զб𣺶ȡ׸ǿЧУͳƿɽĸ 
@@ -294,116 +873,227 @@ static inline void skipPreamble(const char*& p, const char* end)
 	}
 }
 
-// ֻɽĸ䡢ƣ
-static inline int countFloatsOnLine(const char* p, const char* end)
+//  [p, eol) зֶβ㣻ֶ
+// ؽָǰ maxVals д valsvals Ϊգֻ
+static inline int parseLineFloats(const char* p, const char* eol, double* vals, int maxVals)
 {
 	int cnt = 0;
-	const char* q = p;
 	for (;;)
 	{
-		// н
-		if (q >= end || *q == '\n') break;
-		if (*q == '\r') { ++q; if (q < end && *q == '\n') ++q; break; }
-
 		// ָ
-		while (q < end && (*q == ' ' || *q == '\t')) ++q;
-		if (q >= end || *q == '\n') break;
+		p = TxtScan::SkipBlanks(p, eol);
+		if (p >= eol) break;
 
-		// һ
+		// һ㣨С߿· from_chars
 		double v;
-		auto res = std::from_chars(q, end, v);
+		auto res = FastFloat::Parse(p, eol, v);
 		if (res.ec != std::errc()) {
-			// ֣һζһհ׻β
-			while (q < end && *q != ' ' && *q != '\t' && *q != '\n' && *q != '\r') ++q;
-		}
-		else {
-			++cnt;
-			q = res.ptr;
+			// ֣һζһհ׻β
+			p = TxtScan::FindDelim(p, eol);
+			continue;
 		}
+		if (cnt < maxVals) vals[cnt] = v;
+		++cnt;
+		p = res.ptr;
 	}
 	return cnt;
 }
 
-// Զб + ӳ汾
-template<typename PathT>
-static bool loadTxtMappedAutoImpl(const PathT& path, CloudDataStore& self)
+// Զбв֣ʼ + У-1 = ûУ
+struct AutoLayout
 {
-	MappedView mv;
-	if (!mapFile(path, mv)) return false;
-	const char* beg = mv.data;
-	const char* end = mv.data + mv.size;
-	const char* ptr = beg;
+	int Normal = -1;
+	TxtAttrColumns Attr;
+};
 
-	// 1) λ׸ЧУͳƱпɽ
-	skipPreamble(ptr, end);
-	if (ptr >= end) { mv.close(); return false; }
-	int nFirst = countFloatsOnLine(ptr, end);
+// PTS ǵһУ p 
+static inline void skipCountLine(const char*& p, const char* end)
+{
+	const char* q = p;
+	skipPreamble(q, end);
+	const char* eol = TxtScan::FindEOL(q, end);
+	double c;
+	if (parseLineFloats(q, eol, &c, 1) == 1 && c == std::floor(c))
+		p = nextLine(eol, end);
+}
 
-	// >=6 Ϊ XYZ + NX NY NZ XYZ
-	const bool withN = (nFirst >= 6);
+// Float32 ֲԭ㣺 detectAutoLayout ͬעͺ͵Уȡ׸ 3 УͷнȻȡ
+static void autoOrigin(const char* p, const char* end, double o[3])
+{
+	o[0] = o[1] = o[2] = 0.0;
+	skipCountLine(p, end);
+	while (p < end)
+	{
+		skipPreamble(p, end);
+		if (p >= end) break;
+		const char* eol = TxtScan::FindEOL(p, end);
+		double v[3];
+		if (parseLineFloats(p, eol, v, 3) >= 3)
+		{
+			for (int k = 0; k < 3; ++k) o[k] = originOf(v[k]);
+			return;
+		}
+		p = nextLine(eol, end);
+	}
+}
+
+// бвʱ׸ЧȡǸ
+static const int kLayoutSampleLines = 32;
 
-	// 2) reserve
-	size_t nLines = 0;
-	for (const char* q = beg; q < end; ++q) if (*q == '\n') ++nLines;
-	if (nLines == 0) { mv.close(); return false; }
+// е n ͸ȡֵв֣
+//   XYZ        3    XYZ I      4    XYZ I C      5
+//   XYZ N      6    XYZ N I    7    XYZ N RGB    9
+//   XYZ RGB    6    XYZ RGB N  9
+//   XYZ I RGB  7    XYZ I RGB N 10PTS
+// ɫоݣڲﶼ 0..255 ҳֹ 1 ֵ뵥λ֣
+//  >= 6 еԭ򣬵 4~6 е򣬶кԡ
+static AutoLayout detectAutoLayout(const char* p, const char* end)
+{
+	skipCountLine(p, end);
+
+	// Ȳȡ >= 3 Ϊ nвţǱͷ/
+	double v[kLayoutSampleLines][32];
+	int cnt[kLayoutSampleLines];
+	int nSampled = 0;
+	for (; nSampled < kLayoutSampleLines && p < end; ++nSampled)
+	{
+		skipPreamble(p, end);
+		if (p >= end) break;
+		const char* eol = TxtScan::FindEOL(p, end);
+		cnt[nSampled] = std::min(parseLineFloats(p, eol, v[nSampled], 32), 32);
+		p = nextLine(eol, end);
+	}
 
-	std::vector<gp_Pnt> pts; pts.reserve(nLines);
-	std::vector<gp_Dir> nrm; if (withN) nrm.reserve(nLines);
+	int n = 0, nVotes = 0;
+	for (int s = 0; s < nSampled; ++s)
+	{
+		if (cnt[s] < 3) continue;
+		const int votes = (int)std::count(cnt, cnt + nSampled, cnt[s]);
+		if (votes > nVotes) { n = cnt[s]; nVotes = votes; }   // Ʊͬȡȳֵ
+	}
+
+	bool allInt[32];
+	double lo[32], hi[32];
+	for (int i = 0; i < n; ++i) { allInt[i] = true; lo[i] = DBL_MAX; hi[i] = -DBL_MAX; }
+
+	for (int s = 0; s < nSampled; ++s)
+	{
+		if (cnt[s] != n) continue;
+		for (int i = 0; i < n; ++i)
+		{
+			const double x = v[s][i];
+			allInt[i] = allInt[i] && std::isfinite(x) && x == std::floor(x);
+			lo[i] = std::min(lo[i], x);
+			hi[i] = std::max(hi[i], x);
+		}
+	}
+
+	auto isInt = [&](int i) { return i < n && allInt[i]; };
+	auto isRGB = [&](int i) {
+		for (int k = 0; k < 3; ++k)
+			if (!isInt(i + k) || lo[i + k] < 0.0 || hi[i + k] > 255.0) return false;
+		return std::max({ hi[i], hi[i + 1], hi[i + 2] }) > 1.0;
+	};
+
+	AutoLayout L;
+	if ((n == 7 || n == 10) && isInt(3) && isRGB(4)) {
+		L.Attr.Intensity = 3;
+		L.Attr.Color = 4;
+		if (n == 10) L.Normal = 7;
+	}
+	else if (n >= 6 && isRGB(3)) {
+		L.Attr.Color = 3;
+		if (n >= 9) L.Normal = 6;
+	}
+	else if (n >= 6) {
+		L.Normal = 3;
+		if (n >= 9 && isRGB(6)) L.Attr.Color = 6;
+		else if (n == 7 && isInt(6)) L.Attr.Intensity = 6;
+	}
+	else if (n >= 4 && isInt(3)) {
+		L.Attr.Intensity = 3;
+		if (n == 5 && isInt(4)) L.Attr.Classification = 4;
+	}
+	return L;
+}
+
+// һֿĵ/ +  AABB
+struct AutoChunk
+{
+	const char* beg = nullptr;   // [beg, end) 밴ж
+	const char* end = nullptr;
+	CloudTaskControl* ctl = nullptr;   // ɿգֽڻ㱨ȣȡʱǰ
+
+	SoAColumns cols;
+
+	bool   first = true;         // 黹ûе㣨bbox δʼ
+	double xmin = 0, xmax = 0, ymin = 0, ymax = 0, zmin = 0, zmax = 0;
+};
+
+//  [chunk.beg, chunk.end) ڵУ̹߳߳ã֤һ£
+// WithAttr Ϊڿأֻ / ļΪиκη֧
+template <bool WithAttr>
+static void parseAutoChunkT(AutoChunk& chunk, const AutoLayout& layout)
+{
+	const char* ptr = chunk.beg;
+	const char* end = chunk.end;
+
+	const bool withN = layout.Normal >= 0;
+	const int nc = layout.Normal;
+
+	// г reserveԤɨһ
+	const size_t nLines = TxtScan::EstimateLines(ptr, end);
+	SoAColumns& cols = chunk.cols;
+	cols.Reserve(nLines, withN, layout.Attr);
 
-	// 3) ѭļͷɨһ飩
-	ptr = beg;
 	bool first = true;
 	double xmin = 0, xmax = 0, ymin = 0, ymax = 0, zmin = 0, zmax = 0;
 
-	while (ptr < end)
+	CloudTaskControl* ctl = chunk.ctl;
+	const char* reported = ptr;
+	const char* stop = TaskCheckpoint(ctl, ptr, end);
+	CloudPreviewSink* preview = ctl ? ctl->Preview() : nullptr;
+	size_t previewNext = 0;
+
+	for (;;)
 	{
+		if (ptr >= stop)
+		{
+			// 㣺㱨 / Ӧȡ ctl ʱ stop == end
+			if (ptr >= end) break;
+			ctl->Advance((uint64_t)(ptr - reported));
+			reported = ptr;
+			if (ctl->IsCancelled()) break;
+			if (preview) previewNext = feedPreview(cols, previewNext, *preview);
+			stop = TaskCheckpoint(ctl, ptr, end);
+		}
+
 		// /ע/BOM
 		skipPreamble(ptr, end);
 		if (ptr >= end) break;
 
-		// һУ/ࣩ
+		// һУ/ࣩβֻһΣֶз޶ڱ
+		const char* eol = TxtScan::FindEOL(ptr, end);
 		double vals[32];
-		int col = 0;
-		for (;;)
-		{
-			// /ļ
-			if (ptr >= end || *ptr == '\n') { if (ptr < end) ++ptr; break; }
-			if (*ptr == '\r') { ++ptr; if (ptr < end && *ptr == '\n') ++ptr; break; }
-
-			// ָ
-			while (ptr < end && (*ptr == ' ' || *ptr == '\t')) ++ptr;
-			if (ptr >= end || *ptr == '\n') { if (ptr < end) ++ptr; break; }
-			if (*ptr == '\r') { ++ptr; if (ptr < end && *ptr == '\n') ++ptr; break; }
-
-			// 
-			double v;
-			auto res = std::from_chars(ptr, end, v);
-			if (res.ec != std::errc()) {
-				// ֣¸ָβ
-				while (ptr < end && *ptr != ' ' && *ptr != '\t' && *ptr != '\n' && *ptr != '\r') ++ptr;
-				continue;
-			}
-			if (col < (int)std::size(vals)) vals[col] = v;
-			++col;
-			ptr = res.ptr;
-		}
+		const int col = parseLineFloats(ptr, eol, vals, (int)std::size(vals));
+		ptr = nextLine(eol, end);
 
 		// ȡ XYZǰ 3 У
 		if (col >= 3) {
 			const double x = vals[0], y = vals[1], z = vals[2];
-			pts.emplace_back(x, y, z);
+			cols.PushPoint(x, y, z);
 
 			if (withN) {
-				if (col >= 6) {
-					gp_Vec v(vals[3], vals[4], vals[5]);
-					if (v.SquareMagnitude() > 1e-20) nrm.emplace_back(gp_Dir(v));
-					else nrm.emplace_back(0.0, 0.0, 1.0);
+				if (col > nc + 2) {
+					cols.PushNormal(vals[nc], vals[nc + 1], vals[nc + 2]);
 				}
 				else {
-					// в 6 УĬϷ
-					nrm.emplace_back(0.0, 0.0, 1.0);
+					// ĬϷ
+					cols.PushNormal(0.0, 0.0, 1.0);
 				}
 			}
+			if constexpr (WithAttr)
+				cols.PushAttrs(vals, std::min(col, (int)std::size(vals)), layout.Attr);
 
 			if (first) { xmin = xmax = x; ymin = ymax = y; zmin = zmax = z; first = false; }
 			else {
@@ -414,22 +1104,374 @@ static bool loadTxtMappedAutoImpl(const PathT& path, CloudDataStore& self)
 		}
 		//  3 Ը
 	}
+	TaskAdvance(ctl, (uint64_t)(ptr - reported));
+
+	chunk.first = first;
+	chunk.xmin = xmin; chunk.xmax = xmax;
+	chunk.ymin = ymin; chunk.ymax = ymax;
+	chunk.zmin = zmin; chunk.zmax = zmax;
+}
+
+static void parseAutoChunk(AutoChunk& chunk, const AutoLayout& layout)
+{
+	if (layout.Attr.Any())
+		parseAutoChunkT<true>(chunk, layout);
+	else
+		parseAutoChunkT<false>(chunk, layout);
+}
+
+// Сֽļֵÿ߳
+static const size_t kMinBytesPerChunk = size_t(4) << 20;
+
+//  [beg, end) г nChunks Σÿ㶼ĳ '\n' ֮ף
+static std::vector<AutoChunk> splitChunks(const char* beg, const char* end, int nChunks)
+{
+	std::vector<AutoChunk> chunks;
+	const size_t total = (size_t)(end - beg);
+	const char* cur = beg;
+	for (int i = 0; i < nChunks && cur < end; ++i)
+	{
+		const char* stop = end;
+		if (i + 1 < nChunks)
+		{
+			stop = beg + total / nChunks * (i + 1);
+			if (stop <= cur) stop = cur;
+			const void* nl = std::memchr(stop, '\n', (size_t)(end - stop));
+			stop = nl ? static_cast<const char*>(nl) + 1 : end;
+		}
+		AutoChunk c;
+		c.beg = cur;
+		c.end = stop;
+		chunks.push_back(std::move(c));
+		cur = stop;
+	}
+	return chunks;
+}
+
+// Զб + ӳ汾nThreads > 1 ʱжֿ鲢н
+template<typename PathT>
+static bool loadTxtMappedAutoImpl(const PathT& path, CloudDataStore& self, int nThreads,
+	CloudTaskControl* ctl, CloudLoadStats& stats)
+{
+	const auto t0 = clk::now();
 
+	MappedView mv;
+	if (!mapFile(path, mv)) return false;
+	const char* beg = mv.data;
+	const char* end = mv.data + mv.size;
+	const char* ptr = beg;
+
+	// 1) λ׸ЧУͷеȡֵбв
+	skipPreamble(ptr, end);
+	if (ptr >= end) { mv.close(); return false; }
+	const AutoLayout layout = detectAutoLayout(ptr, end);
+	const bool withN = layout.Normal >= 0;
+
+	// 2) ֿ飺߳ļСͬ
+	if (nThreads <= 0) nThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+	const size_t maxChunks = std::max<size_t>(1, mv.size / kMinBytesPerChunk);
+	const int nChunks = (int)std::min<size_t>((size_t)nThreads, maxChunks);
+
+	std::vector<AutoChunk> chunks = splitChunks(beg, end, nChunks);
+	TaskBegin(ctl, CloudTaskStage::Parse, mv.size);
+	if (ctl && ctl->Preview()) ctl->Preview()->Begin(TxtScan::EstimateLines(ptr, end));
+	for (auto& c : chunks) c.ctl = ctl;
+
+	// Float32п鹲ͬһֲԭ㣨׸Чȡ
+	if (self.Precision() == CloudPrecision::Float32)
+	{
+		double o[3];
+		autoOrigin(ptr, end, o);
+		for (auto& c : chunks)
+		{
+			c.cols.F32 = true;
+			std::copy(o, o + 3, c.cols.O);
+		}
+	}
+
+	// 3) ÿһ workerдԼĻ
+	if (chunks.size() == 1)
+	{
+		parseAutoChunk(chunks[0], layout);
+	}
+	else
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(chunks.size() - 1);
+		for (size_t i = 1; i < chunks.size(); ++i)
+			workers.emplace_back(parseAutoChunk, std::ref(chunks[i]), std::cref(layout));
+		parseAutoChunk(chunks[0], layout);   // ̴߳ 0 
+		for (auto& w : workers) w.join();
+	}
+
+	stats.Bytes = mv.size;
 	mv.close();
 
-	if (pts.empty()) return false;
+	// ȡstore ԭ
+	if (TaskCancelled(ctl)) return false;
+
+	// 4) һԺϲ˳ƴӵ/ͬʱϲ bbox
+	size_t total = 0;
+	for (const auto& c : chunks) total += c.cols.Size();
+	if (total == 0) return false;
+
+	SoAColumns cols;
+	cols.Swap(chunks[0].cols);
+	if (chunks.size() > 1) cols.Reserve(total, withN, layout.Attr);
 
-	if (withN) self.SetXYZNAndBBox(std::move(pts), std::move(nrm), xmin, xmax, ymin, ymax, zmin, zmax);
-	else       self.SetXYZAndBBox(std::move(pts), xmin, xmax, ymin, ymax, zmin, zmax);
+	bool first = true;
+	double xmin = 0, xmax = 0, ymin = 0, ymax = 0, zmin = 0, zmax = 0;
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		AutoChunk& c = chunks[i];
+		if (i > 0)
+		{
+			cols.Append(c.cols);
+			c.cols.Release();   // ͷſ黺壬ѹͷֵ
+		}
+		if (c.first) continue;
+		if (first) {
+			xmin = c.xmin; xmax = c.xmax; ymin = c.ymin; ymax = c.ymax; zmin = c.zmin; zmax = c.zmax;
+			first = false;
+		}
+		else {
+			xmin = std::min(xmin, c.xmin); xmax = std::max(xmax, c.xmax);
+			ymin = std::min(ymin, c.ymin); ymax = std::max(ymax, c.ymax);
+			zmin = std::min(zmin, c.zmin); zmax = std::max(zmax, c.zmax);
+		}
+	}
+
+	stats.Points = cols.Size();
+	cols.MoveTo(self, xmin, xmax, ymin, ymax, zmin, zmax);
+
+	stats.ParseMs = std::chrono::duration<double, std::milli>(clk::now() - t0).count();
 	return true;
 }
 
 //  Զб API 
 bool CloudDataStore::LoadTxtMappedAuto(const std::wstring& path)
 {
-	return loadTxtMappedAutoImpl(path, *this);
+	return loadTxtMappedAutoImpl(path, *this, parseThreads_, task_, loadStats_);
 }
 bool CloudDataStore::LoadTxtMappedAuto(const std::string& path)
 {
-	return loadTxtMappedAutoImpl(path, *this);
+	return loadTxtMappedAutoImpl(path, *this, parseThreads_, task_, loadStats_);
+}
+// ---------- ʽƻ ----------
+static bool saveBinaryImpl(const std::filesystem::path& path, const CloudSoAView& soa,
+	const std::vector<CloudAttrView>& attrs, const Bnd_Box& box, uint32_t pointOrder, const FileStamp* source)
+{
+	if (soa.Empty()) return false;
+
+	CloudBinHeader hdr = {};
+	std::memcpy(hdr.Magic, kCloudBinMagic, sizeof(hdr.Magic));
+	hdr.Version = kCloudBinVersion;
+	hdr.Flags = (soa.HasNormals() ? CloudBin_HasNormals : 0u) | (soa.IsFloat() ? CloudBin_Float32 : 0u);
+	hdr.Count = soa.Size;
+	box.Get(hdr.BBox[0], hdr.BBox[1], hdr.BBox[2], hdr.BBox[3], hdr.BBox[4], hdr.BBox[5]);
+	if (source) { hdr.SourceSize = source->size; hdr.SourceMTime = source->mtime; }
+	std::copy(soa.Origin, soa.Origin + 3, hdr.Origin);
+	hdr.AttrCount = (uint32_t)attrs.size();
+	hdr.PointOrder = pointOrder;
+
+	const void* cols[CloudBinCol_Count] = { soa.X, soa.Y, soa.Z, soa.NX, soa.NY, soa.NZ };
+	if (soa.IsFloat())
+	{
+		const void* fcols[CloudBinCol_Count] = { soa.FX, soa.FY, soa.FZ, soa.FNX, soa.FNY, soa.FNZ };
+		std::copy(fcols, fcols + CloudBinCol_Count, cols);
+	}
+	const uint64_t colBytes = (uint64_t)soa.Size * CloudBinElemSize(hdr.Flags);
+	uint64_t off = CloudBinAlignUp(sizeof(CloudBinHeader) + attrs.size() * sizeof(CloudBinAttr));
+	for (int c = 0; c < CloudBinCol_Count; ++c)
+	{
+		if (!cols[c]) continue;
+		hdr.Offset[c] = off;
+		off = CloudBinAlignUp(off + colBytes);
+	}
+
+	std::vector<CloudBinAttr> attrRecs(attrs.size());
+	for (size_t a = 0; a < attrs.size(); ++a)
+	{
+		CloudBinAttr& rec = attrRecs[a];
+		rec = {};
+		rec.Semantic = (uint32_t)attrs[a].Semantic;
+		rec.Type = (uint32_t)attrs[a].Layout.Type;
+		rec.Components = (uint32_t)attrs[a].Layout.Components;
+		rec.Offset = off;
+		off = CloudBinAlignUp(off + (uint64_t)soa.Size * attrs[a].Layout.ElemBytes());
+	}
+
+	// дʱļٸ;ʧ°
+	std::filesystem::path tmp = path;
+	tmp += ".tmp";
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		if (!out) return false;
+
+		static const char zeros[kCloudBinAlign] = {};
+		uint64_t pos = 0;
+		auto padTo = [&](uint64_t target) {
+			out.write(zeros, (std::streamsize)(target - pos));
+			pos = target;
+		};
+
+		out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+		pos = sizeof(hdr);
+		if (!attrRecs.empty())
+		{
+			out.write(reinterpret_cast<const char*>(attrRecs.data()), (std::streamsize)(attrRecs.size() * sizeof(CloudBinAttr)));
+			pos += attrRecs.size() * sizeof(CloudBinAttr);
+		}
+		for (int c = 0; c < CloudBinCol_Count; ++c)
+		{
+			if (!cols[c]) continue;
+			padTo(hdr.Offset[c]);
+			out.write(reinterpret_cast<const char*>(cols[c]), (std::streamsize)colBytes);
+			pos += colBytes;
+		}
+		for (size_t a = 0; a < attrs.size(); ++a)
+		{
+			const uint64_t bytes = (uint64_t)soa.Size * attrs[a].Layout.ElemBytes();
+			padTo(attrRecs[a].Offset);
+			out.write(static_cast<const char*>(attrs[a].Data), (std::streamsize)bytes);
+			pos += bytes;
+		}
+		out.close();
+		if (out.fail()) { std::error_code ec; std::filesystem::remove(tmp, ec); return false; }
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmp, path, ec);
+	if (ec) { std::filesystem::remove(tmp, ec); return false; }
+	return true;
+}
+
+bool CloudDataStore::SaveBinary(const std::wstring& path, const FileStamp* source) const
+{
+	return saveBinaryImpl(std::filesystem::path(path), SoA(), Attributes(), BndAll_, pointOrder_, source);
+}
+bool CloudDataStore::SaveBinary(const std::string& path, const FileStamp* source) const
+{
+	return saveBinaryImpl(std::filesystem::u8path(path), SoA(), Attributes(), BndAll_, pointOrder_, source);
+}
+
+// УļͷзΧȫͨŽӹӳ
+bool CloudDataStore::adoptMapping_(MappedView mv, const FileStamp* expectedSource)
+{
+	CloudBinHeader hdr;
+	bool ok = mv.size >= sizeof(hdr);
+	if (ok) {
+		std::memcpy(&hdr, mv.data, sizeof(hdr));
+		ok = std::memcmp(hdr.Magic, kCloudBinMagic, sizeof(hdr.Magic)) == 0
+			&& hdr.Version == kCloudBinVersion
+			&& hdr.Count > 0
+			&& hdr.Count <= (uint64_t)mv.size / CloudBinElemSize(hdr.Flags);
+	}
+	if (ok && expectedSource)
+		ok = hdr.SourceSize == expectedSource->size && hdr.SourceMTime == expectedSource->mtime;
+
+	const bool withN = ok && (hdr.Flags & CloudBin_HasNormals) != 0;
+	const bool f32 = ok && (hdr.Flags & CloudBin_Float32) != 0;
+	const uint64_t elem = CloudBinElemSize(hdr.Flags);
+	const char* cols[CloudBinCol_Count] = {};
+	const int nCols = withN ? CloudBinCol_Count : CloudBinCol_NX;
+	for (int c = 0; ok && c < nCols; ++c)
+	{
+		const uint64_t off = hdr.Offset[c];
+		const uint64_t bytes = hdr.Count * elem;
+		ok = off >= sizeof(hdr) && off % elem == 0
+			&& off <= (uint64_t)mv.size && bytes <= (uint64_t)mv.size - off;
+		if (ok) cols[c] = mv.data + off;
+	}
+
+	// Ա / ͱ AttrLayoutOf һ£зΧԽ
+	std::vector<CloudAttrView> attrs;
+	const uint64_t tableEnd = sizeof(hdr) + (uint64_t)(ok ? hdr.AttrCount : 0) * sizeof(CloudBinAttr);
+	ok = ok && hdr.AttrCount <= (uint32_t)AttrSemantic::User2 + 1 && tableEnd <= (uint64_t)mv.size;
+	for (uint32_t a = 0; ok && a < hdr.AttrCount; ++a)
+	{
+		CloudBinAttr rec;
+		std::memcpy(&rec, mv.data + sizeof(hdr) + a * sizeof(CloudBinAttr), sizeof(rec));
+
+		CloudAttrView v;
+		v.Semantic = (AttrSemantic)rec.Semantic;
+		v.Layout = AttrLayoutOf(v.Semantic);
+		const uint64_t bytes = hdr.Count * v.Layout.ElemBytes();
+		ok = rec.Semantic >= (uint32_t)AttrSemantic::Color && rec.Semantic <= (uint32_t)AttrSemantic::User2
+			&& rec.Type == (uint32_t)v.Layout.Type && rec.Components == (uint32_t)v.Layout.Components
+			&& rec.Offset >= tableEnd && rec.Offset % sizeof(float) == 0
+			&& rec.Offset <= (uint64_t)mv.size && bytes <= (uint64_t)mv.size - rec.Offset;
+		for (const CloudAttrView& prev : attrs)
+			ok = ok && prev.Semantic != v.Semantic;
+		if (!ok) break;
+		v.Data = mv.data + rec.Offset;
+		v.Size = (size_t)hdr.Count;
+		attrs.push_back(v);
+	}
+	if (!ok) { mv.close(); return false; }
+
+	// ݣӳṩ
+	invalidateSoA_();
+	ClearAttributes();
+	std::vector<Standard_Real>().swap(X_); std::vector<Standard_Real>().swap(Y_); std::vector<Standard_Real>().swap(Z_);
+	std::vector<Standard_Real>().swap(NX_); std::vector<Standard_Real>().swap(NY_); std::vector<Standard_Real>().swap(NZ_);
+	std::vector<float>().swap(X32_); std::vector<float>().swap(Y32_); std::vector<float>().swap(Z32_);
+	std::vector<float>().swap(NX32_); std::vector<float>().swap(NY32_); std::vector<float>().swap(NZ32_);
+
+	mappedSoA_ = CloudSoAView();
+	if (f32)
+	{
+		mappedSoA_.FX = reinterpret_cast<const float*>(cols[CloudBinCol_X]);
+		mappedSoA_.FY = reinterpret_cast<const float*>(cols[CloudBinCol_Y]);
+		mappedSoA_.FZ = reinterpret_cast<const float*>(cols[CloudBinCol_Z]);
+		mappedSoA_.FNX = reinterpret_cast<const float*>(cols[CloudBinCol_NX]);
+		mappedSoA_.FNY = reinterpret_cast<const float*>(cols[CloudBinCol_NY]);
+		mappedSoA_.FNZ = reinterpret_cast<const float*>(cols[CloudBinCol_NZ]);
+		std::copy(hdr.Origin, hdr.Origin + 3, mappedSoA_.Origin);
+	}
+	else
+	{
+		mappedSoA_.X = reinterpret_cast<const Standard_Real*>(cols[CloudBinCol_X]);
+		mappedSoA_.Y = reinterpret_cast<const Standard_Real*>(cols[CloudBinCol_Y]);
+		mappedSoA_.Z = reinterpret_cast<const Standard_Real*>(cols[CloudBinCol_Z]);
+		mappedSoA_.NX = reinterpret_cast<const Standard_Real*>(cols[CloudBinCol_NX]);
+		mappedSoA_.NY = reinterpret_cast<const Standard_Real*>(cols[CloudBinCol_NY]);
+		mappedSoA_.NZ = reinterpret_cast<const Standard_Real*>(cols[CloudBinCol_NZ]);
+	}
+	mappedSoA_.Size = (size_t)hdr.Count;
+	mappedAttrs_ = std::move(attrs);
+
+	mapping_ = std::shared_ptr<const MappedView>(new MappedView(mv),
+		[](const MappedView* p) { const_cast<MappedView*>(p)->close(); delete p; });
+
+	BndAll_.SetVoid();
+	BndAll_.Update(hdr.BBox[0], hdr.BBox[1], hdr.BBox[2]);
+	BndAll_.Update(hdr.BBox[3], hdr.BBox[4], hdr.BBox[5]);
+	pointOrder_ = hdr.PointOrder;
+
+	// ļ뵱ǰòͬתһΣʱ㿽
+	const CloudPrecision want = precision_;
+	precision_ = f32 ? CloudPrecision::Float32 : CloudPrecision::Double;
+	SetPrecision(want);
+	return true;
+}
+
+void CloudDataStore::releaseMapping_()
+{
+	mapping_.reset();
+	mappedSoA_ = CloudSoAView();
+	std::vector<CloudAttrView>().swap(mappedAttrs_);
+}
+
+bool CloudDataStore::LoadBinaryMapped(const std::wstring& path, const FileStamp* expectedSource)
+{
+	MappedView mv;
+	if (!mapFile(path, mv)) return false;
+	return adoptMapping_(mv, expectedSource);
+}
+bool CloudDataStore::LoadBinaryMapped(const std::string& path, const FileStamp* expectedSource)
+{
+	MappedView mv;
+	if (!mapFile(path, mv)) return false;
+	return adoptMapping_(mv, expectedSource);
 }
\ No newline at end of file
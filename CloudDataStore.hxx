@@ -6,6 +6,11 @@
 #include <vector>
 #include <optional>
 #include <string>
+#include <memory>
+#include <algorithm>
+#include "MappedFile.hxx"
+#include "AttrSemantic.hxx"
+#include "CloudTask.hxx"
 
 // SoA ͼָʹСӵ
 struct CloudSoAView
@@ -18,31 +23,139 @@ struct CloudSoAView
 	const Standard_Real* NY = nullptr;
 	const Standard_Real* NZ = nullptr;
 
+	// float32 洢ģʽ double ָΪգ飻 = Origin + FX[i]򲻴 Origin
+	const float* FX = nullptr;
+	const float* FY = nullptr;
+	const float* FZ = nullptr;
+	const float* FNX = nullptr;
+	const float* FNY = nullptr;
+	const float* FNZ = nullptr;
+	Standard_Real Origin[3] = { 0.0, 0.0, 0.0 };
+
 	size_t Size = 0;
 
-	bool HasNormals() const { return NX != nullptr && NY != nullptr && NZ != nullptr; }
-	bool Empty()     const { return Size == 0; }
+	bool IsFloat()    const { return FX != nullptr; }
+	bool HasNormals() const { return (NX != nullptr && NY != nullptr && NZ != nullptr) || FNX != nullptr; }
+	bool Empty()      const { return Size == 0; }
+
+	void Point(size_t i, Standard_Real& x, Standard_Real& y, Standard_Real& z) const
+	{
+		if (X) { x = X[i]; y = Y[i]; z = Z[i]; }
+		else   { x = Origin[0] + FX[i]; y = Origin[1] + FY[i]; z = Origin[2] + FZ[i]; }
+	}
+
+	void Normal(size_t i, Standard_Real& x, Standard_Real& y, Standard_Real& z) const
+	{
+		if (NX) { x = NX[i]; y = NY[i]; z = NZ[i]; }
+		else    { x = FNX[i]; y = FNY[i]; z = FNZ[i]; }
+	}
+};
+
+// ͼɫ / ǿ /  / ûУӵݣData Ϊձʾûи
+struct CloudAttrView
+{
+	AttrSemantic Semantic = AttrSemantic::User0;
+	AttrLayout   Layout;
+	const void*  Data = nullptr;
+	size_t       Size = 0;    // Ԫ = Size * Layout.Components
+
+	bool Empty() const { return Data == nullptr || Size == 0; }
+
+	template <class T>
+	const T* As() const { return static_cast<const T*>(Data); }
+};
+
+// ı︽ڵкţ-1 = ûУColor Ϊ R УG / B 
+// ֵضϵԪ͵ķΧɫ 0..255ǿ 0..65535 0..255
+struct TxtAttrColumns
+{
+	int Color = -1;
+	int Intensity = -1;
+	int Classification = -1;
+
+	bool Any() const { return Color >= 0 || Intensity >= 0 || Classification >= 0; }
+};
+
+// 洢
+//   Double  : ÿ 6  double 48 ֽڣ
+//   Float32 : Ծֲԭ floatÿ 24 ֽڣԭ㸽 8 km  0.5 mm
+//             ԭ = ׸Ч㣨궼ܽĵһ㣩ȡ
+//             ıأע͡PTS Сͷ SetPrecision ת
+enum class CloudPrecision
+{
+	Double,
+	Float32,
+};
+
+// һıصͳƣֽ /  / ʱ
+struct CloudLoadStats
+{
+	size_t Bytes = 0;
+	size_t Points = 0;
+	double ParseMs = 0.0;   // ӳ +  + д store ܺʱ
+
+	double MBps() const { return ParseMs > 0.0 ? (double)Bytes / (1024.0 * 1024.0) / (ParseMs * 1e-3) : 0.0; }
 };
 
 class CloudDataStore {
 public:
 	// ---- Ϣ ----
-	size_t Size() const { return P_.size(); }
+	size_t Size() const { return mapping_ ? mappedSoA_.Size : std::max({ X_.size(), X32_.size(), releasedSize_ }); }
 	const Bnd_Box& BBox() const { return BndAll_; }
 
-	// ----  ----
-	const std::vector<gp_Pnt>& Points() const { return P_; }
-	std::vector<gp_Pnt>& Points() { return P_; }
-
 	// ----  ----
-	bool HasNormals() const { return !N_.empty(); }
-	const std::vector<gp_Dir>& Normals() const { return N_; }
-	const gp_Dir* NormalPtrOrNull(size_t i) const { return (i < N_.size()) ? &N_[i] : nullptr; }
+	bool HasNormals() const { return mapping_ ? mappedSoA_.HasNormals() : (!NX_.empty() || !NX32_.empty()); }
 
-	// ---- SoA ͼ ----
+	// ---- 洢ȣӰ֮ LoadTxtMapped*͵ת ----
+	void SetPrecision(CloudPrecision p);
+	CloudPrecision Precision() const { return precision_; }
+
+	// ---- SoA ͼ洢лӳУκת ----
 	CloudSoAView SoA() const;
 
-	// ---- ãXYZ / XYZ+NԶ bbox ----
+	// ---- AoS ͼ״εʱ SoA һݿڴ淭´ SoA() ----
+	const std::vector<gp_Pnt>& Points() const;
+	const std::vector<gp_Dir>& Normals() const;
+	const gp_Dir* NormalPtrOrNull(size_t i) const { return (i < Normals().size()) ? &Normals()[i] : nullptr; }
+
+	// ͷ Points() / Normals() ɵļݿ
+	void ReleaseCompatViews() const;
+
+	// ---- УԪͰ̶ AttrLayoutOfͬ ----
+	bool HasAttribute(AttrSemantic s) const { return !Attribute(s).Empty(); }
+	CloudAttrView Attribute(AttrSemantic s) const;
+	std::vector<CloudAttrView> Attributes() const;
+
+	// Ԫ AttrLayoutOf(s) һ¡Ϊ Size() * 򷵻 false
+	// SetColumns* / SetXYZ* ȫԣҪ
+	bool SetAttribute(AttrSemantic s, std::vector<uint8_t> data);
+	bool SetAttribute(AttrSemantic s, std::vector<uint16_t> data);
+	bool SetAttribute(AttrSemantic s, std::vector<float> data);
+	void ClearAttributes();
+
+	// ---- ãֱӽӹ SoA У޿nx/ny/nz Ϊձʾ޷ ----
+	void SetColumns(std::vector<Standard_Real> x, std::vector<Standard_Real> y, std::vector<Standard_Real> z,
+		std::vector<Standard_Real> nx = {}, std::vector<Standard_Real> ny = {}, std::vector<Standard_Real> nz = {});
+	void SetColumnsAndBBox(std::vector<Standard_Real> x, std::vector<Standard_Real> y, std::vector<Standard_Real> z,
+		std::vector<Standard_Real> nx, std::vector<Standard_Real> ny, std::vector<Standard_Real> nz,
+		Standard_Real xmin, Standard_Real xmax,
+		Standard_Real ymin, Standard_Real ymax,
+		Standard_Real zmin, Standard_Real zmax);
+
+	// ---- ãfloat32 У originͬʱѾе Float32 ----
+	void SetColumns32AndBBox(const Standard_Real origin[3],
+		std::vector<float> x, std::vector<float> y, std::vector<float> z,
+		std::vector<float> nx, std::vector<float> ny, std::vector<float> nz,
+		Standard_Real xmin, Standard_Real xmax,
+		Standard_Real ymin, Standard_Real ymax,
+		Standard_Real zmin, Standard_Real zmax);
+
+	// ---- ͷ / Укӳ䶼ŵΧСǺб ----
+	// tile ֮ãCloudTileSetup::Quantize˺ SoA() ΪգSaveBinary / PermutePoints  false
+	void ReleaseCoordinates();
+	bool CoordinatesReleased() const { return releasedSize_ > 0; }
+
+	// ---- ãAoS 룬 SoA кXYZ / XYZ+NԶ bbox ----
 	void SetXYZ(std::vector<gp_Pnt> pts);
 	void SetXYZN(std::vector<gp_Pnt> pts, std::vector<gp_Dir> nrm);
 
@@ -60,41 +173,119 @@ public:
 	bool LoadTxtMappedAuto(const std::wstring& path);
 	bool LoadTxtMappedAuto(const std::string& path);
 
+	// ---- ߳0 = ӲԶ1 = ̣߳߳޹ ----
+	void SetParseThreads(int n) { parseThreads_ = n < 0 ? 0 : n; }
+	int  ParseThreads() const { return parseThreads_; }
+
+	// ----  / ȡ֮ LoadTxtMapped* ֽڻ㱨 Parse ׶ν ----
+	// ȡʱط false ҲĶݣctl ڼڼЧnullptr ر
+	void SetTaskControl(CloudTaskControl* ctl) { task_ = ctl; }
+
+	// ---- һ LoadTxtMapped* ͳ ----
+	const CloudLoadStats& LastLoadStats() const { return loadStats_; }
+
 	// ---- ıӳ ----
 	bool LoadTxtMapped(const std::wstring& path,
 		int xCol = 0, int yCol = 1, int zCol = 2,
 		std::optional<int> nxCol = {},
 		std::optional<int> nyCol = {},
 		std::optional<int> nzCol = {},
-		int totalColsPerLine = 3);
+		int totalColsPerLine = 3,
+		const TxtAttrColumns& attrCols = TxtAttrColumns());
 
 	bool LoadTxtMapped(const std::string& path,
 		int xCol = 0, int yCol = 1, int zCol = 2,
 		std::optional<int> nxCol = {},
 		std::optional<int> nyCol = {},
 		std::optional<int> nzCol = {},
-		int totalColsPerLine = 3);
+		int totalColsPerLine = 3,
+		const TxtAttrColumns& attrCols = TxtAttrColumns());
+
+	// ---- ʽƻ棨.ocb CloudBinaryFormat.hxx----
+	// source ΪʱдԴļȡʱɾݴжϻǷ
+	bool SaveBinary(const std::wstring& path, const FileStamp* source = nullptr) const;
+	bool SaveBinary(const std::string& path, const FileStamp* source = nullptr) const;
+
+	// 㿽ȡļӳSoA() ֱָӳڴ
+	// expectedSource Ϊļͷ¼Ĳһʱ falseڣ
+	bool LoadBinaryMapped(const std::wstring& path, const FileStamp* expectedSource = nullptr);
+	bool LoadBinaryMapped(const std::string& path, const FileStamp* expectedSource = nullptr);
+
+	bool IsMapped() const { return mapping_ != nullptr; }
+
+	// ---- ţµĵ i  = ԭ order[i] 㣬 /  / һ ----
+	// order  0..Size()-1 һУ򷵻 false ҲĶݣӳеȿд洢
+	bool PermutePoints(const std::vector<int>& order);
+
+	// ǣ0 = Դļ˳PermutePoints ΪеɢУ .ocb 棬
+	// ±ⲿݣ tile 棩ݴж±Ƿ񻹶Ե
+	uint32_t PointOrder() const { return pointOrder_; }
 
 private:
 	void computeBBox_();
 
-	// SoA ڲάֻҪʱ AoS(P_/N_) һ
+	// SetColumns / SetColumnsAndBBox ãȡ double Уݺԣbox ΪʱΧУ
+	// ǰΪ Float32 ʱ漴ת
+	void adoptColumns_(std::vector<Standard_Real>& x, std::vector<Standard_Real>& y, std::vector<Standard_Real>& z,
+		std::vector<Standard_Real>& nx, std::vector<Standard_Real>& ny, std::vector<Standard_Real>& nz, const Bnd_Box* box);
+
+	// ݱãӳͼͼ
 	void invalidateSoA_();
-	void rebuildSoA_() const;
+
+	bool adoptMapping_(MappedView mv, const FileStamp* expectedSource);
+	void releaseMapping_();
+
+	// һиԵд洢 AttrLayoutOf(Semantic).Type ֻһ
+	struct AttrBuffer
+	{
+		AttrSemantic Semantic = AttrSemantic::User0;
+		std::vector<uint8_t>  U8;
+		std::vector<uint16_t> U16;
+		std::vector<float>    F32;
+	};
+
+	template <class T>
+	bool setAttribute_(AttrSemantic s, std::vector<T>& data, AttrType type);
+
+	// ȡȫԣӳеȿд洢תǰ
+	std::vector<AttrBuffer> takeAttributes_();
 
 private:
-	// AoS 洢
-	std::vector<gp_Pnt> P_;   // 
-	std::vector<gp_Dir> N_;   // 򣬿ɿգsize()==0
-
-	// SoA mutable
-	mutable std::vector<Standard_Real> X_;
-	mutable std::vector<Standard_Real> Y_;
-	mutable std::vector<Standard_Real> Z_;
-	mutable std::vector<Standard_Real> NX_;
-	mutable std::vector<Standard_Real> NY_;
-	mutable std::vector<Standard_Real> NZ_;
-	mutable bool soaDirty_ = true;
+	// SoA 洢NX_/NY_/NZ_ Ϊձʾ޷
+	std::vector<Standard_Real> X_;
+	std::vector<Standard_Real> Y_;
+	std::vector<Standard_Real> Z_;
+	std::vector<Standard_Real> NX_;
+	std::vector<Standard_Real> NY_;
+	std::vector<Standard_Real> NZ_;
+
+	// Float32 ģʽ洢 double жѡһ origin_
+	std::vector<float> X32_;
+	std::vector<float> Y32_;
+	std::vector<float> Z32_;
+	std::vector<float> NX32_;
+	std::vector<float> NY32_;
+	std::vector<float> NZ32_;
+	Standard_Real origin_[3] = { 0.0, 0.0, 0.0 };
+	CloudPrecision precision_ = CloudPrecision::Double;
+
+	// AoS ͼmutablePoints() / Normals() ״εʱɣ
+	mutable std::vector<gp_Pnt> P_;
+	mutable std::vector<gp_Dir> N_;
+
+	// ԣУӳģʽָӳڴ
+	std::vector<AttrBuffer>    attrs_;
+	std::vector<CloudAttrView> mappedAttrs_;
 
 	Bnd_Box BndAll_;
+	uint32_t pointOrder_ = 0;
+	size_t releasedSize_ = 0;   // ReleaseCoordinates ʱĵ֮ Size() Ա
+
+	// ӳģʽmapping_ ӳ䣬mappedSoA_ ָе
+	std::shared_ptr<const MappedView> mapping_;
+	CloudSoAView mappedSoA_;
+
+	int parseThreads_ = 0;
+	CloudTaskControl* task_ = nullptr;
+	CloudLoadStats loadStats_;
 };
\ No newline at end of file
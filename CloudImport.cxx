@@ -0,0 +1,149 @@
+// CloudImport.cxx
+#include "CloudImport.hxx"
+
+CloudImportJob::CloudImportJob(CloudImportRequest request)
+	: request_(std::move(request))
+	, preview_(request_.PreviewPoints)
+{
+}
+
+CloudImportJob::~CloudImportJob()
+{
+	Cancel();
+	Wait();
+}
+
+void CloudImportJob::Start()
+{
+	if (State() != CloudImportState::Pending)
+		return;
+	state_.store((int)CloudImportState::Running, std::memory_order_release);
+	worker_ = std::thread(&CloudImportJob::run_, this);
+}
+
+void CloudImportJob::Wait()
+{
+	if (worker_.joinable())
+		worker_.join();
+}
+
+CloudImportResult CloudImportJob::TakeResult()
+{
+	Wait();
+	return std::move(result_);
+}
+
+std::shared_ptr<CloudDataStore> CloudImportJob::TakePreview()
+{
+	if (!request_.Streaming)
+		return nullptr;
+
+	const std::size_t n = preview_.Size();
+	if (n == 0 || n < 2 * previewTaken_)
+		return nullptr;
+
+	std::vector<double> xyz;
+	preview_.Snapshot(xyz);
+	const std::size_t m = xyz.size() / 3;
+	std::vector<Standard_Real> x(m), y(m), z(m);
+	for (std::size_t i = 0; i < m; ++i)
+	{
+		x[i] = xyz[i * 3]; y[i] = xyz[i * 3 + 1]; z[i] = xyz[i * 3 + 2];
+	}
+	previewTaken_ = m;
+
+	auto store = std::make_shared<CloudDataStore>();
+	store->SetColumns(std::move(x), std::move(y), std::move(z));
+	return store;
+}
+
+std::shared_ptr<CloudDataStore> CloudImportJob::ParsedStore() const
+{
+	std::lock_guard<std::mutex> lock(storeMutex_);
+	return parsedStore_;
+}
+
+void CloudImportJob::finish_(CloudImportState state)
+{
+	if (state != CloudImportState::Succeeded)
+	{
+		result_.Store.reset();
+		result_.TileSet = CloudTileSet();
+	}
+	// release：UI 线程看到结束状态时，result_ 已经写完
+	state_.store((int)state, std::memory_order_release);
+}
+
+void CloudImportJob::run_()
+{
+	const CloudImportRequest& req = request_;
+
+	auto store = std::make_shared<CloudDataStore>();
+	store->SetPrecision(req.Precision);
+	store->SetParseThreads(req.ParseThreads);
+
+	FileStamp stamp;
+	const bool hasStamp = statFile(req.Path.native(), stamp);
+
+	// 1) 优先用列式二进制缓存（零拷贝映射），源文件变了就重新解析
+	std::filesystem::path binPath = req.Path;
+	binPath += ".ocb";
+	if (req.BinaryCache && hasStamp)
+		result_.StoreFromCache = store->LoadBinaryMapped(binPath.native(), &stamp);
+
+	const bool reorder = req.Setup.ReorderPoints && !req.Streaming;
+	bool needBinarySave = false;
+
+	if (!result_.StoreFromCache)
+	{
+		if (req.Streaming)
+			control_.SetPreview(&preview_);
+		store->SetTaskControl(&control_);
+		const bool ok = store->LoadTxtMappedAuto(req.Path.native());
+		store->SetTaskControl(nullptr);
+		if (control_.IsCancelled()) { finish_(CloudImportState::Cancelled); return; }
+		if (!ok)
+		{
+			result_.Error = "failed to parse point cloud text";
+			finish_(CloudImportState::Failed);
+			return;
+		}
+
+		// 写缓存失败（如目录只读）不影响本次导入；要重排点序时等划分完再写，免得写两遍
+		needBinarySave = req.BinaryCache && hasStamp;
+		if (needBinarySave && !reorder)
+		{
+			store->SaveBinary(binPath.native(), &stamp);
+			needBinarySave = false;
+		}
+	}
+
+	// 之后 store 只读，流式显示可以先拿去用
+	if (req.Streaming)
+	{
+		std::lock_guard<std::mutex> lock(storeMutex_);
+		parsedStore_ = store;
+	}
+
+	// 2) tile 层级 + 各级 LOD
+	CloudTileSetup setup = req.Setup;
+	if (req.TileCache && hasStamp)
+	{
+		setup.CachePath = req.Path;
+		setup.CachePath += ".octiles";
+		setup.CacheSource = stamp;
+	}
+	if (!BuildCloudTileSet(*store, setup, result_.TileSet, &control_,
+		req.Streaming ? &stream_ : nullptr))
+	{
+		finish_(CloudImportState::Cancelled);
+		return;
+	}
+
+	// 点序变了（.octiles 按新点序写的），.ocb 也要跟着重写
+	if ((needBinarySave || result_.TileSet.PointsReordered) && req.BinaryCache && hasStamp)
+		store->SaveBinary(binPath.native(), &stamp);
+
+	result_.Store = std::move(store);
+	finish_(CloudImportState::Succeeded);
+}
@@ -0,0 +1,102 @@
+// CloudImport.hxx
+#pragma once
+#include "CloudDataStore.hxx"
+#include "CloudTileSet.hxx"
+#include "CloudTask.hxx"
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 一次导入的参数
+struct CloudImportRequest
+{
+	std::filesystem::path Path;                          // 文本点云
+	bool                  BinaryCache = true;            // 读写旁路 .ocb
+	bool                  TileCache = true;              // 读写旁路 .octiles（会覆盖 Setup 里的缓存路径）
+	CloudPrecision        Precision = CloudPrecision::Double;
+	int                   ParseThreads = 0;              // 见 CloudDataStore::SetParseThreads
+	CloudTileSetup        Setup;
+
+	// 流式显示：解析时积累预览样本，划分时逐个推出叶子（见 TakePreview / TakeStreamedTiles）
+	bool                  Streaming = false;
+	std::size_t           PreviewPoints = 65536;         // 预览样本的目标点数
+};
+
+enum class CloudImportState : int
+{
+	Pending,      // 尚未 Start
+	Running,
+	Succeeded,
+	Failed,
+	Cancelled,
+};
+
+// 导入结果：交给渲染线程的 AIS_Cloud::SetTileSet
+struct CloudImportResult
+{
+	std::shared_ptr<CloudDataStore> Store;
+	CloudTileSet                    TileSet;
+	bool                            StoreFromCache = false;   // 命中了 .ocb
+	std::string                     Error;                    // Failed 时的原因
+};
+
+// 后台导入：解析 -> 八叉划分 -> 各级 LOD 都在工作线程完成
+//
+// UI 线程轮询 State / Stage / StageFraction，可随时 Cancel（在下一个检查点生效）；
+// 结束后在渲染线程 TakeResult，再建 AIS 对象。不依赖 MFC / OCCT 视图。
+class CloudImportJob
+{
+public:
+	explicit CloudImportJob(CloudImportRequest request);
+	~CloudImportJob();   // 未结束则取消并等待工作线程退出
+
+	CloudImportJob(const CloudImportJob&) = delete;
+	CloudImportJob& operator=(const CloudImportJob&) = delete;
+
+	// 启动工作线程，只能调用一次
+	void Start();
+	void Cancel() { control_.Cancel(); }
+	void Wait();
+
+	CloudImportState State() const { return (CloudImportState)state_.load(std::memory_order_acquire); }
+	bool IsFinished() const { return State() >= CloudImportState::Succeeded; }
+
+	CloudTaskStage Stage() const { return control_.Stage(); }
+	double StageFraction() const { return control_.Fraction(); }
+
+	// 结束后取走结果（只能取一次）；未结束时先等待
+	CloudImportResult TakeResult();
+
+	// ---- 流式显示（Request().Streaming），UI 线程轮询 ----
+	// 预览样本比上次取走时至少翻一倍时，返回由样本组成的小 store（只有坐标），否则 nullptr
+	std::shared_ptr<CloudDataStore> TakePreview();
+
+	// 解析完成后的完整 store（只读共享，可先拿去建列视图），之前为 nullptr
+	std::shared_ptr<CloudDataStore> ParsedStore() const;
+
+	// 取走目前已完成的叶子 tile（见 CloudTileStream），返回个数
+	std::size_t TakeStreamedTiles(std::vector<ColumnTile>& out) { return stream_.Take(out); }
+
+	const CloudImportRequest& Request() const { return request_; }
+
+private:
+	void run_();
+	void finish_(CloudImportState state);
+
+private:
+	CloudImportRequest request_;
+	CloudTaskControl   control_;
+	CloudImportResult  result_;
+	std::atomic<int>   state_{ (int)CloudImportState::Pending };
+	std::thread        worker_;
+
+	CloudPreviewSink                preview_;
+	std::size_t                     previewTaken_ = 0;   // 上次 TakePreview 的样本数（UI 线程）
+	CloudTileStream                 stream_;
+	mutable std::mutex              storeMutex_;
+	std::shared_ptr<CloudDataStore> parsedStore_;
+};
@@ -10,50 +10,27 @@
 #include <cmath>
 
 // ----------- AIS_Cloud 需要暴露的最小接口 ------------
-// 1) 获取根节点（没有就提供“顶层节点”），返回 TileLeaf* 列表
-// 2) 针对某节点：确保某个 stride 的 Rep 已构建（懒创建）
-// 3) 显示/隐藏 “节点+repIdx”
-// 4) 查询节点是否叶子、子节点列表、节点已有的 Reps（stride/pointCount/garr）
+// 1) 把 tile 层级摊平成紧凑节点数组（TileNodeArray），选 LOD 只读它
+// 2) 针对某节点：确保其 GArray 已构建（懒创建，各级 LOD 共用一份）
+// 3) 显示/隐藏 “节点+repIdx”：切 LOD 只改 CurrentLOD 和 tile group 画的顶点数，数组、group 都不动
 //
 
-// 1) 返回节点的包围盒
-static const Bnd_Box& TL_Box(const ColumnTile& n)
+// 1) 把 tiles[from, end) 中的根及其子树追加进节点数组
+static void Cloud_AppendNodes(const Handle(AIS_Cloud)& cloud, std::size_t from, TileNodeArray& nodes)
 {
-	return n.BBox;
-}
-
-// 2) 是否叶子：目前是平铺 tiles，就直接返回 true；
-// 如果以后支持树结构，再改成 !n.Children.empty()
-static bool TL_IsLeaf(const ColumnTile& n)
-{
-	return n.Children.empty();
-}
-
-static std::vector<ColumnTile*> Cloud_GetRoots(const Handle(AIS_Cloud)& cloud)
-{
-	std::vector<ColumnTile*> roots;
 	if (cloud.IsNull())
-		return roots;
+		return;
 
-	auto& tiles = cloud->Tiles();
-	roots.reserve(tiles.size());
-	for (std::size_t i = 0; i < tiles.size(); ++i)
-	{
-		auto& t = tiles[i];
-		if (t.Parent < 0)
-			roots.push_back(&t);
-	}
-	return roots;
+	nodes.AppendRoots(cloud->Tiles(), from);
 }
 
 static void Cloud_BuildRepIfMissing(const Handle(AIS_Cloud)& cloud,
-	ColumnTile& node,
-	int repIdx)
+	ColumnTile& node)
 {
 	if (cloud.IsNull())
 		return;
 
-	cloud->EnsureTileLODArray(node, repIdx);
+	cloud->EnsureTileArray(node);
 }
 
 static void Cloud_ShowNodeRep(const Handle(AIS_Cloud)& cloud,
@@ -63,19 +40,18 @@ static void Cloud_ShowNodeRep(const Handle(AIS_Cloud)& cloud,
 	if (cloud.IsNull())
 		return;
 
-	// 确保该 LOD 有 GArray
-	cloud->EnsureTileLODArray(node, repIdx);
+	// 确保该 tile 有 GArray
+	cloud->EnsureTileArray(node);
 
 	node.Visible = true;
 	node.CurrentLOD = repIdx;
 
-	// 标记 AIS_Cloud 需要重算
-	cloud->SetToUpdate();
+	// 就地改该 tile 的 group，不重算整个展示
+	cloud->UpdateTileGroup(node);
 }
 
 static void Cloud_HideNodeRep(const Handle(AIS_Cloud)& cloud,
-	ColumnTile& node,
-	int /*repIdx*/)
+	ColumnTile& node)
 {
 	if (cloud.IsNull())
 		return;
@@ -83,7 +59,7 @@ static void Cloud_HideNodeRep(const Handle(AIS_Cloud)& cloud,
 	node.Visible = false;
 	node.CurrentLOD = -1;
 
-	cloud->SetToUpdate();
+	cloud->UpdateTileGroup(node);
 }
 
 // ----------------- Controller 实现 -----------------
@@ -100,7 +76,13 @@ void CloudLodController::RegisterCloud(const Handle(AIS_Cloud)& cloud)
 {
 	CloudEntry e;
 	e.cloud = cloud;
-	e.roots = Cloud_GetRoots(cloud); // TODO
+	if (!cloud.IsNull())
+	{
+		e.nodes.Clear();
+		Cloud_AppendNodes(cloud, 0, e.nodes);
+		e.numTiles = cloud->Tiles().size();
+		e.epoch = cloud->TileEpoch();
+	}
 	m_clouds.push_back(std::move(e));
 }
 
@@ -108,18 +90,82 @@ void CloudLodController::UnregisterCloud(const Handle(AIS_Cloud)& cloud)
 {
 	m_clouds.erase(std::remove_if(m_clouds.begin(), m_clouds.end(),
 		[&](const CloudEntry& ce) { return ce.cloud == cloud; }), m_clouds.end());
+	m_activeLast.erase(std::remove_if(m_activeLast.begin(), m_activeLast.end(),
+		[&](const NodeRep& nr) { return nr.cloud == cloud; }), m_activeLast.end());
 }
 
-static int chooseRepIdx_(const ColumnTile& node,
+bool CloudLodController::syncClouds_()
+{
+	bool replaced = false;
+	for (auto& ce : m_clouds)
+	{
+		if (ce.cloud.IsNull())
+			continue;
+
+		if (ce.epoch != ce.cloud->TileEpoch())
+		{
+			// 旧 tile（及其 GArray）已随 tile 集一起释放，不能再 Hide，直接丢掉
+			m_activeLast.erase(std::remove_if(m_activeLast.begin(), m_activeLast.end(),
+				[&](const NodeRep& nr) { return nr.cloud == ce.cloud; }), m_activeLast.end());
+			ce.nodes.Clear();
+			ce.numTiles = 0;
+			ce.epoch = ce.cloud->TileEpoch();
+			m_ctx->Redisplay(ce.cloud, Standard_False);
+			replaced = true;
+		}
+
+		const std::size_t n = ce.cloud->Tiles().size();
+		if (n > ce.numTiles)
+		{
+			Cloud_AppendNodes(ce.cloud, ce.numTiles, ce.nodes);
+			ce.numTiles = n;
+		}
+	}
+	return replaced;
+}
+
+bool CloudLodController::publishLODs_()
+{
+	bool any = false;
+	std::vector<int> published;
+	for (auto& ce : m_clouds)
+	{
+		if (ce.cloud.IsNull() || ce.cloud->PublishTileLODs(published) == 0)
+			continue;
+
+		TileNodeArray& nodes = ce.nodes;
+		for (int t : published)
+		{
+			if (t < (int)nodes.NodeOfTile.size() && nodes.NodeOfTile[t] >= 0)
+				nodes.UpdateLODs((std::size_t)nodes.NodeOfTile[t], ce.cloud->Tiles()[t]);
+		}
+		// 换入的 tile 的 group 等 applyDiff_ 之后随 CommitTileGroups 重建：本帧被隐藏的不必再传一次
+		ce.published = true;
+		any = true;
+	}
+	return any;
+}
+
+std::size_t CloudLodController::PendingLODs() const
+{
+	std::size_t n = 0;
+	for (const auto& ce : m_clouds)
+	{
+		if (!ce.cloud.IsNull())
+			n += ce.cloud->PendingTileLODs();
+	}
+	return n;
+}
+
+static int chooseRepIdx_(int numReps,
 	double pixDiag,
 	const CloudLodController::LodThreshold& th,
 	int lastRepIdx)
 {
-	std::vector<RepLevel> reps = TL_Reps(node);
-	if (reps.empty())
+	if (numReps <= 0)
 		return -1;
 
-	const int maxIdx = (int)reps.size() - 1;
+	const int maxIdx = numReps - 1;
 
 	// 1) 先按“无 hysteresis”方式算一个目标 LOD
 	int baseIdx = 0;
@@ -164,12 +210,46 @@ static int chooseRepIdx_(const ColumnTile& node,
 	return resultIdx;
 }
 
+// 屏幕误差选级：第 k 级的像素误差 = ErrorWorld[k] * pxPerWorld，取不超过 maxErrorPx 的最粗一级。
+// 同样远的 tile，稀的 ErrorWorld 大、会留在更细的级别，密的可以更粗
+static int chooseRepIdxByError_(int numReps,
+	const float* lodError,
+	double pxPerWorld,
+	const CloudLodController::LodThreshold& th,
+	int lastRepIdx)
+{
+	if (numReps <= 0)
+		return -1;
+
+	const double tol = th.maxErrorPx > 0.0 ? th.maxErrorPx : 1.0;
+	auto coarsestUnder = [&](double limit) {
+		for (int k = numReps - 1; k > 0; --k)
+		{
+			if (lodError[k] * pxPerWorld <= limit)
+				return k;
+		}
+		return 0;
+	};
+
+	const int baseIdx = coarsestUnder(tol);
+	if (lastRepIdx < 0 || lastRepIdx >= numReps || baseIdx == lastRepIdx)
+		return baseIdx;
+
+	// hysteresis：变粗要误差明显低于容差，变细要上一帧那级的误差明显超过容差
+	const double h = th.hysteresis <= 0.0 ? 1.0 : th.hysteresis;
+	if (baseIdx > lastRepIdx)
+		return std::max(coarsestUnder(tol / h), lastRepIdx);
+	return lodError[lastRepIdx] * pxPerWorld > tol * h ? baseIdx : lastRepIdx;
+}
+
 bool CloudLodController::Tick()
 {
 	auto t0 = clk::now();
 
+	const bool replaced = syncClouds_();
+	const bool published = publishLODs_();
 	selectLOD_();
-	bool anyChanged = applyDiff_();
+	bool anyChanged = applyDiff_() || replaced || published;
 
 	m_rt.selectMs = std::chrono::duration<double, std::milli>(
 		clk::now() - t0).count();
@@ -209,11 +289,12 @@ void CloudLodController::selectLOD_baseline_()
 	// 为每个 tile 记录一份状态，方便后面用预算统一调节 LOD
 	struct TileState
 	{
-		Handle(AIS_Cloud) cloud;
-		ColumnTile* node = nullptr;
+		CloudEntry*             entry = nullptr;
+		int                     node = -1;     // entry->nodes 下标
 		double                  pixDiag = 0.0;
-		std::vector<int>        lodCost;   // 每个 LOD 的点数
+		const int32_t*          lodCost = nullptr;   // 每个 LOD 的点数（TileNodeArray::LodPoints）
 		int                     maxIdx = 0;
+		int                     lastIdx = -1;   // 上一帧显示的 LOD，-1 = 未显示
 		int                     desiredIdx = 0; // 按像素计算的理想 LOD
 		int                     currentIdx = 0; // 经过预算调整后的实际 LOD
 	};
@@ -234,91 +315,108 @@ void CloudLodController::selectLOD_baseline_()
 
 	const std::int64_t budget = (std::int64_t)m_budget.maxPoints;
 	const bool disableLOD = (budget <= 0) || (globalPoints <= (std::size_t)budget);
+	const double hyst = m_th.hysteresis <= 0.0 ? 1.0 : m_th.hysteresis;
 
 	// -------------------------
 	// 1) 收集所有需要显示的 tile，计算每个 tile 的 pixDiag 和各级 LOD 的点数
+	//    只读 TileNodeArray：DFS 先序线性扫，剪掉的子树直接跳到 End[k]
 	// -------------------------
 	for (auto& ce : m_clouds)
 	{
 		if (ce.cloud.IsNull())
 			continue;
 
-		auto& allTiles = ce.cloud->Tiles();
-
-		for (ColumnTile* root : ce.roots)
+		const TileNodeArray& nodes = ce.nodes;
+		const std::size_t numNodes = nodes.Size();
+		std::size_t k = 0;
+		while (k < numNodes)
 		{
-			if (!root)
-				continue;
-
-			std::vector<ColumnTile*> stack;
-			stack.push_back(root);
+			const std::size_t next = (std::size_t)nodes.End[k];
 
-			while (!stack.empty())
+			//	太小的 tile 连同子树直接丢掉（pixDiagHide）
+			const double pd = LeafProjector::PixelDiag(m_view, &nodes.Box[k * 6], nodes.Origin, 0);
+			if (pd <= m_th.pixDiagHide)
 			{
-				ColumnTile* node = stack.back();
-				stack.pop_back();
-				if (!node)
-					continue;
-
-				//	太小的 tile 直接丢掉（pixDiagHide）
-				const Bnd_Box& box = TL_Box(*node);
-				const double pd = LeafProjector::PixelDiag(m_view, box, 0);
-				if (pd <= m_th.pixDiagHide)
-					continue;
-
-				if (!TL_IsLeaf(*node))
-				{
-					for (int childIdx : node->Children)
-					{
-						if (childIdx < 0 || childIdx >= allTiles.size())
-							continue;
-						stack.push_back(&allTiles[childIdx]);
-					}
-					continue;
-				}
+				k = next;
+				continue;
+			}
 
-				std::vector<RepLevel> reps = TL_Reps(*node);
-				if (reps.empty())
-					continue;
+			const int numReps = nodes.NumLODs(k);
+			int lastIdx = nodes.Current[k] == TileNodeArray::kHidden ? -1 : (int)nodes.Current[k];
+			if (lastIdx >= numReps)
+				lastIdx = -1;
 
-				TileState st;
-				st.cloud = ce.cloud;
-				st.node = node;
-				st.pixDiag = pd;
-				st.maxIdx = (int)reps.size() - 1;
-				st.lodCost.resize(reps.size());
-				for (std::size_t i = 0; i < reps.size(); ++i)
+			if (nodes.ChildCount[k] > 0)
+			{
+				// 投影够小的内部节点直接画它的代表采样（BuildNodeLODs），不再下探子树；
+				// 上一帧画的就是它时阈值放宽 hysteresis 倍，免得在父子之间来回切
+				// 屏幕误差模式下，代表采样的像素误差已在容差内的节点也不再下探
+				double stopPx = m_th.pixDiagNode;
+				double tolPx = m_th.maxErrorPx;
+				if (lastIdx >= 0)
 				{
-					st.lodCost[i] = reps[i].pointCount;
+					stopPx *= hyst;
+					tolPx *= hyst;
 				}
-
-				// 1.2 取上一帧 LOD 作为 hysteresis 的参考
-				int lastIdx = node->CurrentLOD;
-				if (lastIdx < 0 || lastIdx > st.maxIdx)
-					lastIdx = -1;
-
-				int repIdx = 0;
-
-				if (disableLOD || reps.size() == 1)
+				bool stop = pd <= stopPx;
+				if (!stop && m_th.screenError && numReps > 0)
 				{
-					// 小点云或只有一个 LOD：一律用最细（0）
-					repIdx = 0;
+					const double diag = nodes.Diagonal(k);
+					stop = diag > 0.0 && nodes.LodErr(k)[0] * (pd / diag) <= tolPx;
 				}
-				else
+				if (disableLOD || numReps == 0 || !stop)
 				{
-					repIdx = chooseRepIdx_(*node, pd, m_th, lastIdx);
-					if (repIdx < 0)            repIdx = 0;
-					if (repIdx > st.maxIdx)    repIdx = st.maxIdx;
+					++k;   // 下探：第一个子节点紧跟在后面
+					continue;
 				}
+			}
+
+			const std::size_t node = k;
+			k = next;
+			if (numReps == 0)
+				continue;
 
-				st.desiredIdx = repIdx;
-				st.currentIdx = repIdx;
+			TileState st;
+			st.entry = &ce;
+			st.node = (int)node;
+			st.pixDiag = pd;
+			st.maxIdx = numReps - 1;
+			st.lastIdx = lastIdx;
+			st.lodCost = nodes.LodCost(st.node);
 
-				tiles.push_back(std::move(st));
+			int repIdx = 0;
+
+			if (disableLOD || numReps == 1)
+			{
+				// 小点云或只有一个 LOD：一律用最细（0）
+				repIdx = 0;
 			}
+			else if (m_th.screenError)
+			{
+				// 包围盒投影对角线 / 世界对角线 ≈ tile 所在深度上每世界单位的像素数
+				const double diag = nodes.Diagonal(node);
+				const double pxPerWorld = diag > 0.0 ? pd / diag : 0.0;
+				repIdx = chooseRepIdxByError_(numReps, nodes.LodErr(node), pxPerWorld, m_th, lastIdx);
+			}
+			else
+			{
+				// 取上一帧 LOD 作为 hysteresis 的参考
+				repIdx = chooseRepIdx_(numReps, pd, m_th, lastIdx);
+				if (repIdx < 0)            repIdx = 0;
+				if (repIdx > st.maxIdx)    repIdx = st.maxIdx;
+			}
+
+			st.desiredIdx = repIdx;
+			st.currentIdx = repIdx;
+
+			tiles.push_back(st);
 		}
 	}
 
+	// 节点数组里的当前 LOD 与本帧选择一致（applyDiff_ 随后照此显示 / 隐藏）
+	for (auto& ce : m_clouds)
+		std::fill(ce.nodes.Current.begin(), ce.nodes.Current.end(), TileNodeArray::kHidden);
+
 	if (tiles.empty())
 		return;
 
@@ -397,11 +495,23 @@ void CloudLodController::selectLOD_baseline_()
 
 	// -------------------------
 	// 4) 把最终 LOD 结果写入 m_activeNow
+	//    选中的级别还没生成（懒生成）：交给后台补齐，补好之前接着画上一帧的级别，
+	//    新显示的 tile 先画已有的最粗一级
 	// -------------------------
 	for (const TileState& st : tiles)
 	{
-		m_activeNow.push_back(NodeRep{ st.cloud, st.node, st.currentIdx });
-		m_rt.pointsChosen += st.lodCost[st.currentIdx];
+		TileNodeArray& nodes = st.entry->nodes;
+		int idx = st.currentIdx;
+		const int ready = nodes.Ready[st.node];
+		if (idx >= ready)
+		{
+			st.entry->cloud->RequestTileLODs(nodes.Tile[st.node]);
+			idx = (st.lastIdx >= 0 && st.lastIdx < ready) ? st.lastIdx : std::max(ready - 1, 0);
+		}
+
+		nodes.Current[st.node] = (uint8_t)idx;
+		m_activeNow.push_back(NodeRep{ st.entry->cloud, nodes.Tile[st.node], idx });
+		m_rt.pointsChosen += st.lodCost[idx];
 		++m_rt.nodesShown;
 	}
 }
@@ -423,7 +533,7 @@ bool CloudLodController::applyDiff_()
 		};
 
 	auto makeKey = [](const NodeRep& nr)->std::uintptr_t {
-		const auto nodeKey = reinterpret_cast<std::uintptr_t>(nr.node);
+		const auto nodeKey = static_cast<std::uintptr_t>(nr.tile) * 0x100000001b3ull;
 		const auto repKey = static_cast<std::uintptr_t>(nr.repIdx * 0x9e3779b97f4a7c15ull);
 		const auto cloudKey = reinterpret_cast<std::uintptr_t>(nr.cloud.get());
 		return nodeKey ^ repKey ^ (cloudKey << 1);
@@ -441,7 +551,7 @@ bool CloudLodController::applyDiff_()
 	for (const NodeRep& nr : m_activeLast) {
 		if (nowSet.find(makeKey(nr)) == nowSet.end()) {
 			if (!nr.cloud.IsNull()) {
-				Cloud_HideNodeRep(nr.cloud, *nr.node, nr.repIdx);
+				Cloud_HideNodeRep(nr.cloud, nr.cloud->Tiles()[nr.tile]);
 				markDirty(nr.cloud);
 				anyChanged = true;
 			}
@@ -452,17 +562,23 @@ bool CloudLodController::applyDiff_()
 	for (const NodeRep& nr : m_activeNow) {
 		if (lastSet.find(makeKey(nr)) == lastSet.end()) {
 			if (!nr.cloud.IsNull()) {
-				Cloud_BuildRepIfMissing(nr.cloud, *nr.node, nr.repIdx);
-				Cloud_ShowNodeRep(nr.cloud, *nr.node, nr.repIdx);
+				ColumnTile& node = nr.cloud->Tiles()[nr.tile];
+				Cloud_BuildRepIfMissing(nr.cloud, node);
+				Cloud_ShowNodeRep(nr.cloud, node, nr.repIdx);
 				markDirty(nr.cloud);
 				anyChanged = true;
 			}
 		}
 	}
 
-	// 3) 只对“确实有 tile 变化”的 cloud 做 UpdatePresentations
+	// 3) 只对“确实有 tile 变化”的 cloud 提交：group 已就地改好，这里只刷新计数并让 view 重画
+	for (auto& ce : m_clouds) {
+		if (ce.published)
+			markDirty(ce.cloud);
+		ce.published = false;
+	}
 	for (const auto& cloud : dirtyClouds) {
-		m_ctx->Redisplay(cloud, Standard_False);
+		cloud->CommitTileGroups();
 	}
 	anyChanged = dirtyClouds.size() > 0;
 
@@ -0,0 +1,136 @@
+// CloudTask.hxx
+#pragma once
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 长耗时步骤的阶段
+enum class CloudTaskStage : int
+{
+	Idle = 0,
+	Parse,      // 文本解析，进度单位：字节
+	Tile,       // 空间划分，进度单位：点
+	LOD,        // 各级 LOD，进度单位：点
+};
+
+// 解析期间的粗略预览样本（流式导入用）
+//
+// 解析线程在进度检查点把刚解析出的点按 Stride 抽样追加进来，UI 线程随时取快照。
+// Stride 在解析开始时按预估行数和目标点数确定；多线程解析时各块同时推进，样本覆盖各块已解析的部分。
+class CloudPreviewSink
+{
+public:
+	explicit CloudPreviewSink(std::size_t targetPoints = 65536) : target_(std::max<std::size_t>(1, targetPoints)) {}
+
+	// 解析开始：清空样本，按预估行数定抽样步长
+	void Begin(std::size_t estimatedLines)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		xyz_.clear();
+		stride_.store(std::max<std::size_t>(1, estimatedLines / target_), std::memory_order_relaxed);
+	}
+
+	std::size_t Stride() const { return stride_.load(std::memory_order_relaxed); }
+
+	// 追加 n 个点（xyz 交错，世界坐标）
+	void Append(const double* xyz, std::size_t n)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		xyz_.insert(xyz_.end(), xyz, xyz + n * 3);
+	}
+
+	std::size_t Size() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return xyz_.size() / 3;
+	}
+
+	// 复制当前全部样本，返回点数
+	std::size_t Snapshot(std::vector<double>& xyz) const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		xyz = xyz_;
+		return xyz.size() / 3;
+	}
+
+private:
+	mutable std::mutex       mutex_;
+	std::vector<double>      xyz_;
+	std::size_t              target_;
+	std::atomic<std::size_t> stride_{ 1 };
+};
+
+// 进度汇报 + 协作式取消
+//
+// 工作线程在各自的步骤里调用 BeginStage / Advance，并定期检查 IsCancelled 提前返回；
+// 其他线程（UI）随时可以读 Stage / Fraction 或请求 Cancel。
+// 只用 relaxed 原子量：进度是估计值，取消只需“最终可见”。
+class CloudTaskControl
+{
+public:
+	void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+	bool IsCancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+	// 开始一个阶段，total 为该阶段的总工作量（0 = 未知）
+	void BeginStage(CloudTaskStage stage, uint64_t total)
+	{
+		done_.store(0, std::memory_order_relaxed);
+		total_.store(total, std::memory_order_relaxed);
+		stage_.store((int)stage, std::memory_order_relaxed);
+	}
+
+	// 多个工作线程可同时累加
+	void Advance(uint64_t n) { done_.fetch_add(n, std::memory_order_relaxed); }
+
+	CloudTaskStage Stage() const { return (CloudTaskStage)stage_.load(std::memory_order_relaxed); }
+
+	// 可选的预览样本：解析检查点往里抽样（须在解析开始前设置）
+	void SetPreview(CloudPreviewSink* sink) { preview_ = sink; }
+	CloudPreviewSink* Preview() const { return preview_; }
+
+	// 当前阶段完成比例 [0, 1]
+	double Fraction() const
+	{
+		const uint64_t total = total_.load(std::memory_order_relaxed);
+		if (total == 0) return 0.0;
+		const double f = (double)done_.load(std::memory_order_relaxed) / (double)total;
+		return f < 1.0 ? f : 1.0;
+	}
+
+private:
+	std::atomic<bool>     cancelled_{ false };
+	std::atomic<int>      stage_{ (int)CloudTaskStage::Idle };
+	std::atomic<uint64_t> done_{ 0 };
+	std::atomic<uint64_t> total_{ 0 };
+	CloudPreviewSink*     preview_ = nullptr;
+};
+
+// 解析循环每处理这么多字节汇报一次进度并检查取消
+static const std::size_t kTaskCheckBytes = std::size_t(1) << 20;
+
+// 下一个检查点：无 ctl 时就是 end，解析循环与不带进度时完全相同
+inline const char* TaskCheckpoint(const CloudTaskControl* ctl, const char* p, const char* end)
+{
+	return (ctl && (std::size_t)(end - p) > kTaskCheckBytes) ? p + kTaskCheckBytes : end;
+}
+
+// ctl 可为空的便捷写法
+inline bool TaskCancelled(const CloudTaskControl* ctl) { return ctl && ctl->IsCancelled(); }
+inline void TaskBegin(CloudTaskControl* ctl, CloudTaskStage stage, uint64_t total) { if (ctl) ctl->BeginStage(stage, total); }
+inline void TaskAdvance(CloudTaskControl* ctl, uint64_t n) { if (ctl) ctl->Advance(n); }
+
+// 在 nThreads 个线程上各跑一次 fn(t)，本线程跑第 0 个
+inline void RunOnThreads(int nThreads, const std::function<void(int)>& fn)
+{
+	std::vector<std::thread> workers;
+	workers.reserve((std::size_t)std::max(0, nThreads - 1));
+	for (int t = 1; t < nThreads; ++t)
+		workers.emplace_back(fn, t);
+	fn(0);
+	for (auto& w : workers) w.join();
+}
@@ -0,0 +1,132 @@
+// CloudTileSet.cxx
+#include "CloudTileSet.hxx"
+#include "ColumnTileLOD.hxx"
+#include "ColumnTileCache.hxx"
+
+namespace {
+	// 按叶子的划分顺序重排 store，使每个叶子的点在列里连续：叶子 Indices 变成 [OrderOffset, OrderOffset + n)，
+	// 已有的各级 LOD 索引随之改写并重新绑定到新的列视图。叶子 Indices 已是嵌套 LOD 点序（BuildTileLODs），
+	// 重排后各级 LOD 都是叶子起点开始的一段。点序已经是划分顺序时不动，返回 false
+	static bool ReorderPointsByTiles(CloudDataStore& store, CloudTileSet& set)
+	{
+		const std::size_t n = store.Size();
+		std::vector<int> order(n, -1);
+		bool identity = true;
+		for (const ColumnTile& t : set.Tiles)
+		{
+			if (!t.Children.empty()) continue;
+			if (t.OrderOffset + t.Indices.size() > n) return false;
+			for (std::size_t i = 0; i < t.Indices.size(); ++i)
+			{
+				order[t.OrderOffset + i] = t.Indices[i];
+				identity = identity && t.Indices[i] == (int)(t.OrderOffset + i);
+			}
+		}
+		if (identity || !store.PermutePoints(order))
+			return false;
+
+		std::vector<int> newIndex(n);
+		for (std::size_t i = 0; i < n; ++i)
+			newIndex[order[i]] = (int)i;
+
+		set.Columns = BuildCloudColumns(store);
+		for (ColumnTile& t : set.Tiles)
+		{
+			for (int& id : t.Indices) id = newIndex[id];
+			for (TileLODLevel& lvl : t.LODs)
+			{
+				if (lvl.Indices.empty()) continue;
+				for (int& id : lvl.Indices) id = newIndex[id];
+				BindLODColumns(set.Columns, lvl);
+			}
+		}
+		return true;
+	}
+} // namespace
+
+bool BuildCloudTileSet(CloudDataStore& store, const CloudTileSetup& setup,
+	CloudTileSet& out, CloudTaskControl* ctl, CloudTileStream* stream)
+{
+	out = CloudTileSet();
+
+	// 1) 从 CloudDataStore 的 SoA 构建 Column 视图
+	out.Columns = BuildCloudColumns(store);
+
+	// 2) 有效的 tile 缓存直接读回层级和各级 LOD 索引，跳过 3) 4)
+	TileCacheKey cacheKey(setup.CacheSource, out.Columns, setup.Tiling, setup.MaxLODLevel);
+	cacheKey.PointOrder = store.PointOrder();
+	cacheKey.LazyLODs = setup.LazyLODs;
+	if (!setup.CachePath.empty())
+		out.FromCache = ColumnTileCache::Load(setup.CachePath.native(), cacheKey, out.Columns, out.Tiles);
+
+	// 流式时 UI 已经拿着 store 的列在画，不能重排
+	const bool reorder = setup.ReorderPoints && !stream;
+
+	if (!out.FromCache)
+	{
+		// 3) 基于 Column 做空间划分（octree / KDtree）
+		// 流式：叶子一出来就建 LOD 并推出去，省掉 4)
+		TileLeafCallback onLeaf;
+		if (stream)
+		{
+			const CloudColumns& columns = out.Columns;
+			const int maxLOD = setup.MaxLODLevel;
+			const bool lazy = setup.LazyLODs;
+			onLeaf = [&columns, maxLOD, lazy, stream](ColumnTile& leaf) {
+				if (lazy)
+					BuildBaseLOD(columns, leaf, leaf.Indices, maxLOD);
+				else
+					BuildTileLODs(columns, leaf, maxLOD);
+				stream->Push(leaf);
+			};
+		}
+
+		TilingStatsColumns stats;
+		CloudTilingColumns::Build(out.Columns, out.Tiles, stats, setup.Tiling, ctl, onLeaf);
+		if (TaskCancelled(ctl))
+			return false;
+
+		// 4) 为每个 Tile 构建嵌套的各级 LOD，并在内部计算每级的 ErrorWorld；叶子 Indices 换成嵌套点序
+		//    懒生成时只建 LOD0，其余级别显示时由 AIS_Cloud 的后台队列补齐
+		if (!stream)
+		{
+			BuildLODsForTiles(out.Columns, out.Tiles, setup.MaxLODLevel, ctl, setup.LazyLODs, setup.Tiling.Threads);
+			if (TaskCancelled(ctl))
+				return false;
+		}
+
+		// 4.2) 点按（嵌套 LOD 点序的）划分顺序重排后，每级 LOD 都是连续一段，之后内部节点采样和填 GPU 数组都是顺序读列
+		if (reorder)
+			out.PointsReordered = ReorderPointsByTiles(store, out);
+
+		// 4.5) 内部节点的代表采样 LOD，远处由控制器直接画内部节点；每个约一个叶子的点数
+		BuildNodeLODs(out.Columns, out.Tiles, (std::size_t)std::max(1, setup.Tiling.LeafMaxPoints),
+			setup.MaxLODLevel, ctl, setup.LazyLODs);
+		if (TaskCancelled(ctl))
+			return false;
+
+		// 写缓存失败（如目录只读）不影响本次显示
+		cacheKey.PointOrder = store.PointOrder();
+		if (!setup.CachePath.empty())
+			ColumnTileCache::Save(setup.CachePath.native(), cacheKey, out.Tiles);
+	}
+	else if (reorder && ReorderPointsByTiles(store, out))
+	{
+		// 缓存里的层级是在原点序上建的：重排后按新点序覆盖写回
+		out.PointsReordered = true;
+		cacheKey.PointOrder = store.PointOrder();
+		ColumnTileCache::Save(setup.CachePath.native(), cacheKey, out.Tiles);
+	}
+
+	// 5) 点按划分顺序重排过的话，叶子和各级 LOD 的索引表都是区间，换成 (First, Stride) 释放掉
+	CompactTileIndices(out.Columns, out.Tiles);
+
+	// 6) 各 tile 按 LOD0 点序编码成量化块，释放全局索引；ErrorWorld 计入量化误差（不进缓存，读回后重新量化）
+	if (setup.Quantize)
+	{
+		QuantizeTiles(out.Columns, out.Tiles, setup.Tiling.Threads);
+		out.Quantized = true;
+	}
+
+	return true;
+}
@@ -0,0 +1,76 @@
+// CloudTileSet.hxx
+#pragma once
+#include "CloudDataStore.hxx"
+#include "CloudColumns.hxx"
+#include "ColumnTile.hxx"
+#include "CloudTilingColumns.hxx"
+#include "CloudTask.hxx"
+#include "MappedFile.hxx"
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+// tile 层级的构建参数
+struct CloudTileSetup
+{
+	TilingParams          Tiling;
+	int                   MaxLODLevel = 2;
+	bool                  ReorderPoints = false;   // 把 store 的点按划分顺序重排，每个叶子的点在列里连续，索引表换成区间（流式时不做）
+	bool                  LazyLODs = false;   // 只建 LOD0，更粗的级别等控制器第一次要用时由 AIS_Cloud 的后台队列补齐（见 TileLODQueue）
+	bool                  Quantize = false;   // tile 的点编码成 16 位量化块（见 QuantizeTile），AIS_Cloud 接管后释放 store 的坐标 / 法向列
+	std::filesystem::path CachePath;          // .octiles 旁路缓存，空 = 不用缓存
+	FileStamp             CacheSource;        // 源文件戳，缓存键的一部分
+};
+
+// 一份点云的列视图 + tile 层级 + 各级 LOD；Columns 指向 store 的内存，store 须比它活得久
+// Quantized 时 tile 只带量化块、不再引用 Columns，store 的坐标列可以释放（AIS_Cloud::SetTileSet 里做）
+struct CloudTileSet
+{
+	CloudColumns            Columns;
+	std::vector<ColumnTile> Tiles;
+	bool                    FromCache = false;   // 命中了 .octiles
+	bool                    PointsReordered = false;   // 本次重排了 store 的点序，旁路 .ocb 须重写才能与 .octiles 对上
+	bool                    Quantized = false;   // 各 tile 已换成量化块（CloudTileSetup::Quantize）
+};
+
+// 流式划分的输出队列：叶子带着各级 LOD 一完成就推进来，渲染线程分批取走追加显示
+// 推进来的是拷贝，Parent / Children 清空（作为独立的根显示），LOD 视图须在取走后重新绑定
+class CloudTileStream
+{
+public:
+	void Push(const ColumnTile& leaf)
+	{
+		ColumnTile t;
+		t.Depth = leaf.Depth;
+		t.BBox = leaf.BBox;
+		t.Indices = leaf.Indices;
+		t.OrderOffset = leaf.OrderOffset;
+		t.OrderCount = leaf.OrderCount;
+		t.LODs = leaf.LODs;
+		t.LODsPlanned = leaf.LODsPlanned;
+		std::lock_guard<std::mutex> lock(mutex_);
+		pending_.push_back(std::move(t));
+	}
+
+	// 取走目前累积的全部叶子，返回个数
+	std::size_t Take(std::vector<ColumnTile>& out)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		out.swap(pending_);
+		pending_.clear();
+		return out.size();
+	}
+
+private:
+	std::mutex              mutex_;
+	std::vector<ColumnTile> pending_;
+};
+
+// 列视图 -> 读缓存，或八叉划分 + 各级 LOD 并写回缓存 -> 压缩索引 -> setup.Quantize 时各 tile 换成 16 位量化块
+// 量化在写缓存之后，store 的列在这里不释放（调用方可能还要写 .ocb）
+// 不碰 AIS / 视图，可在工作线程调用；GPU 数组不在这里建
+// ctl 可空：汇报 Tile / LOD 阶段进度；取消时返回 false，out 内容不完整
+// stream 可空：不为空且未命中缓存时，叶子在划分过程中就建好 LOD 并推给 stream（结果与非流式相同）
+// setup.ReorderPoints 时会就地重排 store（见 CloudDataStore::PermutePoints），此时 store 不能已被别处的列视图引用
+bool BuildCloudTileSet(CloudDataStore& store, const CloudTileSetup& setup,
+	CloudTileSet& out, CloudTaskControl* ctl = nullptr, CloudTileStream* stream = nullptr);
@@ -1,12 +1,18 @@
 // CloudTilingColumns.cxx
 #include "CloudTilingColumns.hxx"
+#include "OctantKernel.hxx"
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <thread>
 
 namespace {
-	// 从 Position 列和索引集合计算 BBox
+	// 从 Position 列和索引区间 [first, last) 计算 BBox
 	static Bnd_Box ComputeBBoxColumn(
 		const Column3f& pos,
-		const std::vector<int>& idx)
+		const int* first,
+		const int* last)
 	{
 		Bnd_Box box;
 		box.SetVoid();
@@ -15,11 +21,32 @@ namespace {
 		const bool dense = pos.IsDense();
 		const std::size_t nGlobal = pos.Count;
 
-		if (dense && idx.empty())
+		if (dense && first == last)
 			return box;
 
-		for (int id : idx)
+		// 下标全部有效时（划分过程中总是如此）走 OctantKernel，一趟 min / max，不逐点构造 gp_Pnt
+		if (dense)
 		{
+			int idMin = *first, idMax = *first;
+			for (const int* it = first; it != last; ++it)
+			{
+				idMin = std::min(idMin, *it);
+				idMax = std::max(idMax, *it);
+			}
+			if (idMin >= 0 && (std::size_t)idMax < nGlobal)
+			{
+				double lo[3] = { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() };
+				double hi[3] = { -lo[0], -lo[1], -lo[2] };
+				OctantKernel::Bounds(pos, first, (std::size_t)(last - first), lo, hi);
+				if (lo[0] <= hi[0])
+					box.Update(lo[0], lo[1], lo[2], hi[0], hi[1], hi[2]);
+				return box;
+			}
+		}
+
+		for (const int* it = first; it != last; ++it)
+		{
+			const int id = *it;
 			int gi = id;
 			if (!dense)
 			{
@@ -31,67 +58,157 @@ namespace {
 
 			if (gi < 0 || (std::size_t)gi >= nGlobal) continue;
 
-			box.Add(gp_Pnt(pos.X[gi], pos.Y[gi], pos.Z[gi]));
+			Standard_Real x, y, z;
+			pos.Get(gi, x, y, z);
+			box.Add(gp_Pnt(x, y, z));
 		}
 
 		return box;
 	}
 
-	// octree 八叉划分：只看 Position 列
+	static Bnd_Box ComputeBBoxColumn(
+		const Column3f& pos,
+		const std::vector<int>& idx)
+	{
+		return ComputeBBoxColumn(pos, idx.data(), idx.data() + idx.size());
+	}
+
+	// 八分统计 -> 各子块 BBox，空八分为 void
+	static void OctantBoxes(const OctantStats& stats, Bnd_Box childBox[8])
+	{
+		for (int k = 0; k < 8; ++k)
+		{
+			childBox[k].SetVoid();
+			if (stats.Count[k] > 0)
+				childBox[k].Update(stats.Min[k][0], stats.Min[k][1], stats.Min[k][2],
+					stats.Max[k][0], stats.Max[k][1], stats.Max[k][2]);
+		}
+	}
+
+	// octree 八叉划分：只看 Position 列，就地重排 idx[first, last)
+	//
+	// 一趟取坐标（OctantKernel::Classify）：算八分码（暂存在 codes）、计数、同时累加各子块的 min / max；
+	// 再按计数前缀和把索引稳定地分发到 scratch 并拷回。codes / scratch 都是与 idx 等长的共享缓冲，不按节点分配。
+	// 返回后子块 k 占 [first + start[k], first + start[k + 1])，块内保持输入顺序（取坐标时按地址递增访问列）
 	static void Partition8Column(
 		const Column3f& pos,
-		const std::vector<int>& inIdx,
+		int* first,
+		int* last,
+		uint8_t* codes,
+		int* scratch,
 		const Bnd_Box& box,
-		std::vector<int> outIdx[8])
+		std::size_t start[9],
+		Bnd_Box childBox[8])
 	{
 		Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
 		box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
-		const Standard_Real cx = Standard_Real(0.5 * (xmin + xmax));
-		const Standard_Real cy = Standard_Real(0.5 * (ymin + ymax));
-		const Standard_Real cz = Standard_Real(0.5 * (zmin + zmax));
-
-		const std::size_t nGlobal = pos.Count;
-
-		for (int id : inIdx)
-		{
-			if (id < 0 || (std::size_t)id >= nGlobal) continue;
-			const Standard_Real x = pos.X[id];
-			const Standard_Real y = pos.Y[id];
-			const Standard_Real z = pos.Z[id];
-
-			int oct = (x >= cx ? 1 : 0)
-				| (y >= cy ? 2 : 0)
-				| (z >= cz ? 4 : 0);
-			outIdx[oct].push_back(id);
-		}
+		const double c[3] = { 0.5 * (xmin + xmax), 0.5 * (ymin + ymax), 0.5 * (zmin + zmax) };
+
+		const std::size_t n = (std::size_t)(last - first);
+		OctantStats stats;
+		stats.Reset();
+		OctantKernel::Classify(pos, first, n, c, codes, stats);
+		OctantBoxes(stats, childBox);
+
+		start[0] = 0;
+		for (int k = 0; k < 8; ++k)
+			start[k + 1] = start[k] + stats.Count[k];
+
+		std::size_t next[8];
+		for (int k = 0; k < 8; ++k)
+			next[k] = start[k];
+		for (std::size_t i = 0; i < n; ++i)
+			scratch[next[codes[i]]++] = first[i];
+		std::copy(scratch, scratch + n, first);
 	}
 
-	// KD 分割：按某一轴的坐标做中位数
-	static void PartitionMedianAxisColumn(
+	// 点数达到这个规模的节点才值得多线程协作划分（每段至少这么多点的一半）
+	static const std::size_t kParallelPartitionMin = std::size_t(1) << 17;
+
+	// Partition8Column 的多线程版本：[first, last) 切成 nThreads 段，
+	// 各段并行算八分码 / 计数 / BBox，按（八分码，段号）前缀和得到每段在各子块中的起点后并行分发、并行拷回。
+	// 子块内仍按输入顺序排列，结果与单线程版本完全相同
+	static void Partition8ColumnParallel(
 		const Column3f& pos,
-		std::vector<int>& inOutIdx,
-		int axis,
-		std::vector<int>& leftIdx,
-		std::vector<int>& rightIdx)
+		int* first,
+		int* last,
+		uint8_t* codes,
+		int* scratch,
+		const Bnd_Box& box,
+		std::size_t start[9],
+		Bnd_Box childBox[8],
+		int nThreads)
 	{
-		auto coord = [&](int id)->Standard_Real {
-			switch (axis)
+		Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+		box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+		const double c[3] = { 0.5 * (xmin + xmax), 0.5 * (ymin + ymax), 0.5 * (zmin + zmax) };
+
+		const std::size_t n = (std::size_t)(last - first);
+		auto segBegin = [n, nThreads](int t) { return n * (std::size_t)t / (std::size_t)nThreads; };
+
+		struct Segment
+		{
+			OctantStats Stats;
+			std::size_t Next[8] = {};
+		};
+		std::vector<Segment> seg((std::size_t)nThreads);
+
+		RunOnThreads(nThreads, [&](int t) {
+			Segment& s = seg[t];
+			s.Stats.Reset();
+			const std::size_t b = segBegin(t);
+			OctantKernel::Classify(pos, first + b, segBegin(t + 1) - b, c, codes + b, s.Stats);
+		});
+
+		OctantStats total;
+		total.Reset();
+		std::size_t sum = 0;
+		for (int k = 0; k < 8; ++k)
+		{
+			start[k] = sum;
+			for (Segment& s : seg)
 			{
-			case 0: return pos.X[id];
-			case 1: return pos.Y[id];
-			default:return pos.Z[id];
+				s.Next[k] = sum;
+				sum += s.Stats.Count[k];
 			}
-			};
+		}
+		start[8] = sum;
+		for (const Segment& s : seg)
+			total.Merge(s.Stats);
+		OctantBoxes(total, childBox);
+
+		RunOnThreads(nThreads, [&](int t) {
+			Segment& s = seg[t];
+			for (std::size_t i = segBegin(t), e = segBegin(t + 1); i < e; ++i)
+				scratch[s.Next[codes[i]]++] = first[i];
+		});
+		RunOnThreads(nThreads, [&](int t) {
+			std::copy(scratch + segBegin(t), scratch + segBegin(t + 1), first + segBegin(t));
+		});
+	}
 
-		const std::size_t mid = inOutIdx.size() / 2;
-		std::nth_element(
-			inOutIdx.begin(),
-			inOutIdx.begin() + mid,
-			inOutIdx.end(),
-			[&](int a, int b) { return coord(a) < coord(b); });
+	using KDPoint = CloudTilingColumns::KDPoint;
+
+	// KD 节点的 BBox：工作数组里坐标是连续的，不用回到列里随机取
+	static Bnd_Box ComputeBBoxKD(const KDPoint* first, const KDPoint* last)
+	{
+		Bnd_Box box;
+		box.SetVoid();
+		for (const KDPoint* p = first; p != last; ++p)
+			box.Update(p->P[0], p->P[1], p->P[2]);
+		return box;
+	}
 
-		leftIdx.assign(inOutIdx.begin(), inOutIdx.begin() + mid);
-		rightIdx.assign(inOutIdx.begin() + mid, inOutIdx.end());
+	// KD 分割：按某一轴的坐标就地做中位数划分，返回分界 mid
+	// 之后 [first, mid) 的坐标都不大于 [mid, last)；坐标相等时按索引排，结果与 nth_element 实现无关
+	static KDPoint* PartitionMedianAxisKD(KDPoint* first, KDPoint* last, int axis)
+	{
+		KDPoint* mid = first + (last - first) / 2;
+		std::nth_element(first, mid, last,
+			[axis](const KDPoint& a, const KDPoint& b) {
+				return a.P[axis] < b.P[axis] || (a.P[axis] == b.P[axis] && a.Id < b.Id);
+			});
+		return mid;
 	}
 
 	// 选择最长轴
@@ -107,33 +224,140 @@ namespace {
 		return 2;
 	}
 
-	// 分裂停止条件
-	static bool StopSplit(int numPoints, int depth, const TilingParams& params)
+	// Morton 码：每轴 21 位，交织成 63 位，x 在最低位（与八叉划分的八分码 x=1 / y=2 / z=4 一致）
+	static const int kMortonBits = 21;
+
+	// 把 21 位整数的各位拉开到每 3 位一位
+	static inline uint64_t MortonSpread21(uint64_t v)
+	{
+		v &= 0x1fffffull;
+		v = (v | v << 32) & 0x1f00000000ffffull;
+		v = (v | v << 16) & 0x1f0000ff0000ffull;
+		v = (v | v << 8) & 0x100f00f00f00f00full;
+		v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+		v = (v | v << 2) & 0x1249249249249249ull;
+		return v;
+	}
+
+	// (codes, idx) 按码的高 keyBits 位做 LSD 基数排序，每趟 11 位；某一位段全部相同的趟直接跳过
+	// 排序是稳定的：高位相同的点保持输入（全局索引）顺序。
+	// 树只用到 3 * 层数 位前缀，更低的位只影响最深格子内的点序，不值得多排几趟
+	static void MortonRadixSort(std::vector<uint64_t>& codes, std::vector<int>& idx, int keyBits)
+	{
+		const int kDigitBits = 11;
+		const int kBuckets = 1 << kDigitBits;
+		const int lowBit = 3 * kMortonBits - keyBits;
+		const int passes = (keyBits + kDigitBits - 1) / kDigitBits;
+		const std::size_t n = codes.size();
+		if (passes <= 0 || n < 2)
+			return;
+
+		// 一趟读完所有位段的直方图
+		std::vector<std::size_t> hist((std::size_t)passes * kBuckets, 0);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			const uint64_t c = codes[i] >> lowBit;
+			for (int p = 0; p < passes; ++p)
+				++hist[(std::size_t)p * kBuckets + ((c >> (p * kDigitBits)) & (kBuckets - 1))];
+		}
+
+		std::vector<uint64_t> codes2(n);
+		std::vector<int> idx2(n);
+		for (int p = 0; p < passes; ++p)
+		{
+			std::size_t* h = hist.data() + (std::size_t)p * kBuckets;
+			const int shift = lowBit + p * kDigitBits;
+			if (h[(codes[0] >> shift) & (kBuckets - 1)] == n)
+				continue;
+
+			std::size_t sum = 0;
+			for (int b = 0; b < kBuckets; ++b)
+			{
+				const std::size_t c = h[b];
+				h[b] = sum;
+				sum += c;
+			}
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				const uint64_t c = codes[i];
+				const std::size_t dst = h[(c >> shift) & (kBuckets - 1)]++;
+				codes2[dst] = c;
+				idx2[dst] = idx[i];
+			}
+			codes.swap(codes2);
+			idx.swap(idx2);
+		}
+	}
+
+	// 包围盒最长边
+	static double LongestEdge(const Bnd_Box& box)
+	{
+		if (box.IsVoid()) return 0.0;
+		Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+		box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+		return std::max(xmax - xmin, std::max(ymax - ymin, zmax - zmin));
+	}
+
+	// 分裂停止条件；box 为节点包围盒，levelsPerOctave = 一层八叉相当于几层（KD 为 3）
+	// LeafMinSize > 0 时深度上限放宽到 kMortonBits 层八叉，由最小尺寸兜底：稠密区域可以比 MaxDepth 分得更深
+	static bool StopSplit(int numPoints, int depth, const Bnd_Box& box, const TilingParams& params, int levelsPerOctave = 1)
 	{
 		if (numPoints <= params.LeafMaxPoints) return true;
-		if (depth >= params.MaxDepth) return true;
+		if (params.LeafMinSize > 0.0)
+		{
+			// 再分一次边长约减半，小于 LeafMinSize 就不分
+			if (LongestEdge(box) < 2.0 * params.LeafMinSize) return true;
+			return depth >= kMortonBits * levelsPerOctave;
+		}
+		if (depth >= params.MaxDepth * levelsPerOctave) return true;
 		return false;
 	}
-} // namespace
 
-int CloudTilingColumns::buildOctreeRecursive(
-	const CloudColumns& columns,
-	const std::vector<int>& inIdx,
-	const Bnd_Box& inBox,
-	int depth,
-	const TilingParams& params,
-	std::vector<ColumnTile>& outTiles)
-{
-	const Column3f& pos = columns.Position;
-	if (!pos.IsValid() || inIdx.empty()) return -1;
+	// 子节点分组：LeafMinPoints > 0 时，相邻的过小八分（在划分顺序里本来就连续）合并成一个叶子，
+	// 合并后不超过 LeafMaxPoints；其余非空八分各成一组。组 g 是八分 [group[g], group[g + 1])，返回组数
+	static int GroupOctants(const std::size_t start[9], const TilingParams& params, int group[9])
+	{
+		const std::size_t minPts = (std::size_t)std::max(0, params.LeafMinPoints);
+		const std::size_t maxPts = (std::size_t)std::max(0, params.LeafMaxPoints);
+		int g = 0;
+		int i = 0;
+		while (i < 8)
+		{
+			const std::size_t c = start[i + 1] - start[i];
+			if (c == 0) { ++i; continue; }
+
+			group[g++] = i++;
+			if (c >= minPts)
+				continue;
+			std::size_t sum = c;
+			for (; i < 8; ++i)
+			{
+				const std::size_t ci = start[i + 1] - start[i];
+				if (ci != 0 && (ci >= minPts || sum + ci > maxPts))
+					break;
+				sum += ci;
+			}
+		}
+		group[g] = 8;
+		return g;
+	}
 
-	if (StopSplit((int)inIdx.size(), depth, params))
+	// 叶子 tile：接管 indices（即划分顺序中的 [offset, offset + indices.size())），并建好 LOD0（视图指向全局 SoA）
+	static ColumnTile MakeLeafTile(
+		const CloudColumns& columns,
+		std::vector<int>&& indices,
+		std::size_t offset,
+		const Bnd_Box& inBox,
+		int depth)
 	{
-		// 叶子节点 -> ColumnTile
+		const Column3f& pos = columns.Position;
+
 		ColumnTile tile;
 		tile.Depth = depth;
-		tile.Indices = inIdx;
-		tile.BBox = inBox.IsVoid() ? ComputeBBoxColumn(pos, inIdx) : inBox;
+		tile.OrderOffset = offset;
+		tile.OrderCount = indices.size();
+		tile.Indices = std::move(indices);
+		tile.BBox = inBox.IsVoid() ? ComputeBBoxColumn(pos, tile.Indices) : inBox;
 
 		// 构建 LOD Level 0
 		TileLODLevel lvl0;
@@ -142,9 +366,7 @@ int CloudTilingColumns::buildOctreeRecursive(
 
 		// Position LOD0：指向全局 SoA + 本 Tile 的索引
 		lvl0.Position.Semantic = AttrSemantic::Position;
-		lvl0.Position.X = pos.X;
-		lvl0.Position.Y = pos.Y;
-		lvl0.Position.Z = pos.Z;
+		lvl0.Position.BindStorage(pos);
 		lvl0.Position.Indices = nullptr;
 		lvl0.Position.Count = pos.Count;   // 全局点数
 
@@ -152,9 +374,7 @@ int CloudTilingColumns::buildOctreeRecursive(
 		if (columns.HasNormal && columns.Normal.IsValid())
 		{
 			lvl0.Normal.Semantic = AttrSemantic::Normal;
-			lvl0.Normal.X = columns.Normal.X;
-			lvl0.Normal.Y = columns.Normal.Y;
-			lvl0.Normal.Z = columns.Normal.Z;
+			lvl0.Normal.BindStorage(columns.Normal);
 			lvl0.Normal.Indices = nullptr;
 			lvl0.Normal.Count = columns.Normal.Count;
 		}
@@ -169,36 +389,84 @@ int CloudTilingColumns::buildOctreeRecursive(
 		//		lvl0.print();
 
 		tile.LODs.push_back(lvl0);
-		const int idx = (int)outTiles.size();
-		outTiles.push_back(std::move(tile));
-		return idx;
+		return tile;
 	}
+	// 并行八叉划分顶层的一个节点：要么在顶层八分（Split），要么整棵子树交给一个任务建在 Tiles 里
+	struct OctreeTopNode
+	{
+		std::size_t             Begin = 0;
+		std::size_t             End = 0;
+		Bnd_Box                 Box;
+		int                     Depth = 0;
+		bool                    Split = false;
+		std::size_t             Start[9] = {};     // Split：各子块在 [Begin, End) 中的起点
+		Bnd_Box                 ChildBox[8];
+		std::vector<int>        Children;          // Split：非空子块对应的节点，按八分码顺序
+		std::vector<ColumnTile> Tiles;             // 未 Split：子树的 DFS 先序，下标从子树根 = 0 起
+	};
+} // namespace
 
-	// 非叶子节点：继续分裂
-	Bnd_Box box = inBox.IsVoid() ? ComputeBBoxColumn(pos, inIdx) : inBox;
+int CloudTilingColumns::buildOctreeRecursive(
+	const CloudColumns& columns,
+	std::vector<int>& idx,
+	std::vector<uint8_t>& codes,
+	std::vector<int>& scratch,
+	std::size_t begin,
+	std::size_t end,
+	const Bnd_Box& inBox,
+	int depth,
+	const TilingParams& params,
+	std::vector<ColumnTile>& outTiles,
+	CloudTaskControl* ctl,
+	const TileLeafCallback& onLeaf)
+{
+	const Column3f& pos = columns.Position;
+	if (!pos.IsValid() || begin >= end) return -1;
+	if (TaskCancelled(ctl)) return -1;
+
+	int* first = idx.data() + begin;
+	int* last = idx.data() + end;
+	const std::size_t numPoints = end - begin;
 
-	std::vector<int> childIdx[8];
-	for (int i = 0; i < 8; ++i)
-		childIdx[i].reserve(inIdx.size() / 4 + 1);
+	const Bnd_Box box = inBox.IsVoid() ? ComputeBBoxColumn(pos, first, last) : inBox;
+	if (StopSplit((int)numPoints, depth, box, params))
+	{
+		// 叶子节点 -> ColumnTile，Indices 是共享缓冲里本区间的唯一一次拷贝
+		const int leafIndex = (int)outTiles.size();
+		outTiles.push_back(MakeLeafTile(columns, std::vector<int>(first, last), begin, box, depth));
+		if (onLeaf) onLeaf(outTiles.back());
+		TaskAdvance(ctl, numPoints);
+		return leafIndex;
+	}
 
-	Partition8Column(pos, inIdx, box, childIdx);
+	// 非叶子节点：继续分裂
+	std::size_t start[9];
+	Bnd_Box childBox[8];
+	Partition8Column(pos, first, last, codes.data() + begin, scratch.data() + begin, box, start, childBox);
 
 	ColumnTile node;
 	node.Depth = depth;
 	node.BBox = box;
+	node.OrderOffset = begin;
+	node.OrderCount = numPoints;
 
 	const int nodeIndex = (int)outTiles.size();
 	outTiles.push_back(std::move(node));
 
-	for (int i = 0; i < 8; ++i)
+	// 相邻的过小八分合并成一个子节点（点数不超过 LeafMaxPoints，递归下去就是叶子）
+	int group[9];
+	const int numGroups = GroupOctants(start, params, group);
+	for (int g = 0; g < numGroups; ++g)
 	{
-		if (childIdx[i].empty()) continue;
-		Bnd_Box cbox = ComputeBBoxColumn(pos, childIdx[i]);
-		const int childIndex = buildOctreeRecursive(columns, childIdx[i], cbox,
-			depth + 1, params, outTiles);
+		Bnd_Box groupBox = childBox[group[g]];
+		for (int i = group[g] + 1; i < group[g + 1]; ++i)
+			groupBox.Add(childBox[i]);
+		const int childIndex = buildOctreeRecursive(columns, idx, codes, scratch,
+			begin + start[group[g]], begin + start[group[g + 1]], groupBox,
+			depth + 1, params, outTiles, ctl, onLeaf);
 		if (childIndex < 0)
 			continue;
-		outTiles[nodeIndex].Parent = nodeIndex;
+		outTiles[childIndex].Parent = nodeIndex;
 		outTiles[nodeIndex].Children.push_back(childIndex);
 	}
 
@@ -209,7 +477,9 @@ void CloudTilingColumns::BuildOctree(
 	const CloudColumns& columns,
 	std::vector<ColumnTile>& outTiles,
 	TilingStatsColumns& stats,
-	const TilingParams& params)
+	const TilingParams& params,
+	CloudTaskControl* ctl,
+	const TileLeafCallback& onLeaf)
 {
 	outTiles.clear();
 	stats = {};
@@ -218,14 +488,459 @@ void CloudTilingColumns::BuildOctree(
 		return;
 
 	const std::size_t n = columns.Position.Count;
-	std::vector<int> rootIdx(n);
+	TaskBegin(ctl, CloudTaskStage::Tile, n);
+
+	// 唯一的一份索引缓冲 + 八分码 / 分发暂存，递归中各节点只持有 [begin, end)
+	std::vector<int> idx(n);
 	for (std::size_t i = 0; i < n; ++i)
-		rootIdx[i] = (int)i;
+		idx[i] = (int)i;
+	std::vector<uint8_t> codes(n);
+	std::vector<int> scratch(n);
+
+	// 任务粒度：每线程约 8 棵子树，便于按大小均衡；太小的点云直接串行
+	const int threads = params.Threads > 0 ? params.Threads : (int)std::max(1u, std::thread::hardware_concurrency());
+	const std::size_t grain = std::max<std::size_t>((std::size_t)std::max(1, params.LeafMaxPoints), n / ((std::size_t)threads * 8));
+	if (threads <= 1 || n <= 2 * grain)
+	{
+		const Bnd_Box rootBox = ComputeBBoxColumn(columns.Position, idx);
+		buildOctreeRecursive(columns, idx, codes, scratch, 0, n, rootBox, 0, params, outTiles, ctl, onLeaf);
+		stats.NumTiles = (int)outTiles.size();
+		stats.TotalPoints = n;
+		return;
+	}
+
+	// 根包围盒也分段并行求
+	std::vector<Bnd_Box> partBox((std::size_t)threads);
+	RunOnThreads(threads, [&](int t) {
+		partBox[t] = ComputeBBoxColumn(columns.Position,
+			idx.data() + n * (std::size_t)t / (std::size_t)threads, idx.data() + n * (std::size_t)(t + 1) / (std::size_t)threads);
+	});
+	std::vector<OctreeTopNode> nodes(1);
+	nodes[0].Begin = 0;
+	nodes[0].End = n;
+	nodes[0].Box.SetVoid();
+	for (const Bnd_Box& b : partBox)
+		nodes[0].Box.Add(b);
+
+	// 1) 顶层逐层分裂：同一层的节点分给各线程，线程比节点多时每个节点再分段协作划分；
+	//    满足叶子条件或点数不超过 grain 的节点不在这里分，留作子树任务
+	std::vector<int> level(1, 0);
+	std::vector<int> subtrees;
+	while (!level.empty())
+	{
+		const int workers = (int)std::min<std::size_t>((std::size_t)threads, level.size());
+		const int segsPerNode = std::max(1, threads / workers);
+		std::atomic<std::size_t> nextNode{ 0 };
+		RunOnThreads(workers, [&](int) {
+			for (std::size_t k; (k = nextNode.fetch_add(1)) < level.size(); )
+			{
+				if (TaskCancelled(ctl)) return;
+				OctreeTopNode& node = nodes[level[k]];
+				const std::size_t numPoints = node.End - node.Begin;
+				if (numPoints <= grain)
+					continue;
+
+				int* first = idx.data() + node.Begin;
+				int* last = idx.data() + node.End;
+				if (node.Box.IsVoid())
+					node.Box = ComputeBBoxColumn(columns.Position, first, last);
+				if (StopSplit((int)numPoints, node.Depth, node.Box, params))
+					continue;
+				const int segs = (int)std::min<std::size_t>((std::size_t)segsPerNode, 2 * numPoints / kParallelPartitionMin);
+				if (segs > 1)
+					Partition8ColumnParallel(columns.Position, first, last, codes.data() + node.Begin, scratch.data() + node.Begin,
+						node.Box, node.Start, node.ChildBox, segs);
+				else
+					Partition8Column(columns.Position, first, last, codes.data() + node.Begin, scratch.data() + node.Begin,
+						node.Box, node.Start, node.ChildBox);
+				node.Split = true;
+			}
+		});
+		if (TaskCancelled(ctl))
+			return;
+
+		// 子节点按八分码顺序登记，进入下一层
+		std::vector<int> nextLevel;
+		for (int id : level)
+		{
+			if (!nodes[id].Split)
+			{
+				subtrees.push_back(id);
+				continue;
+			}
+			// 与 buildOctreeRecursive 相同的八分分组
+			int group[9];
+			const int numGroups = GroupOctants(nodes[id].Start, params, group);
+			for (int g = 0; g < numGroups; ++g)
+			{
+				OctreeTopNode child;
+				child.Begin = nodes[id].Begin + nodes[id].Start[group[g]];
+				child.End = nodes[id].Begin + nodes[id].Start[group[g + 1]];
+				child.Box = nodes[id].ChildBox[group[g]];
+				for (int i = group[g] + 1; i < group[g + 1]; ++i)
+					child.Box.Add(nodes[id].ChildBox[i]);
+				child.Depth = nodes[id].Depth + 1;
+				nodes[id].Children.push_back((int)nodes.size());
+				nextLevel.push_back((int)nodes.size());
+				nodes.push_back(std::move(child));
+			}
+		}
+		level.swap(nextLevel);
+	}
+
+	// 2) 子树任务：大的先做，各线程取下一个未做的任务，照串行算法建在节点自己的 tile 缓冲里
+	std::stable_sort(subtrees.begin(), subtrees.end(), [&nodes](int a, int b) {
+		return nodes[a].End - nodes[a].Begin > nodes[b].End - nodes[b].Begin;
+	});
+	std::atomic<std::size_t> nextTask{ 0 };
+	RunOnThreads((int)std::min<std::size_t>((std::size_t)threads, subtrees.size()), [&](int) {
+		for (std::size_t k; (k = nextTask.fetch_add(1)) < subtrees.size(); )
+		{
+			OctreeTopNode& node = nodes[subtrees[k]];
+			buildOctreeRecursive(columns, idx, codes, scratch, node.Begin, node.End, node.Box,
+				node.Depth, params, node.Tiles, ctl, onLeaf);
+		}
+	});
+	if (TaskCancelled(ctl))
+		return;
+
+	// 3) 按 DFS 先序拼接：分裂过的顶层节点各成一个 tile，子树的 tile 整段搬过来，局部下标加上起点
+	std::size_t total = 0;
+	for (const OctreeTopNode& node : nodes)
+		total += node.Split ? 1 : node.Tiles.size();
+	outTiles.reserve(total);
+
+	std::function<int(int)> emit = [&](int id) -> int {
+		OctreeTopNode& node = nodes[id];
+		if (!node.Split)
+		{
+			if (node.Tiles.empty()) return -1;
+			const int base = (int)outTiles.size();
+			for (ColumnTile& tile : node.Tiles)
+			{
+				if (tile.Parent >= 0) tile.Parent += base;
+				for (int& c : tile.Children) c += base;
+				outTiles.push_back(std::move(tile));
+			}
+			return base;
+		}
 
-	Bnd_Box rootBox = ComputeBBoxColumn(columns.Position, rootIdx);
+		ColumnTile tile;
+		tile.Depth = node.Depth;
+		tile.BBox = node.Box;
+		tile.OrderOffset = node.Begin;
+		tile.OrderCount = node.End - node.Begin;
 
-	buildOctreeRecursive(columns, rootIdx, rootBox, 0, params, outTiles);
+		const int nodeIndex = (int)outTiles.size();
+		outTiles.push_back(std::move(tile));
+		for (int c : node.Children)
+		{
+			const int childIndex = emit(c);
+			if (childIndex < 0)
+				continue;
+			outTiles[childIndex].Parent = nodeIndex;
+			outTiles[nodeIndex].Children.push_back(childIndex);
+		}
+		return nodeIndex;
+	};
+	emit(0);
 
 	stats.NumTiles = (int)outTiles.size();
 	stats.TotalPoints = n;
 }
+
+int CloudTilingColumns::buildKDRecursive(
+	const CloudColumns& columns,
+	std::vector<KDPoint>& pts,
+	std::size_t begin,
+	std::size_t end,
+	const Bnd_Box& inBox,
+	int depth,
+	const TilingParams& params,
+	std::vector<ColumnTile>& outTiles,
+	CloudTaskControl* ctl,
+	const TileLeafCallback& onLeaf)
+{
+	if (begin >= end) return -1;
+	if (TaskCancelled(ctl)) return -1;
+
+	KDPoint* first = pts.data() + begin;
+	KDPoint* last = pts.data() + end;
+	const int numPoints = (int)(end - begin);
+
+	// 二分三次才相当于八叉一层
+	const Bnd_Box box = inBox.IsVoid() ? ComputeBBoxKD(first, last) : inBox;
+	if (numPoints < 2 || StopSplit(numPoints, depth, box, params, 3))
+	{
+		// 叶子节点 -> ColumnTile
+		std::vector<int> indices((std::size_t)numPoints);
+		for (int i = 0; i < numPoints; ++i)
+			indices[i] = first[i].Id;
+
+		const int leafIndex = (int)outTiles.size();
+		outTiles.push_back(MakeLeafTile(columns, std::move(indices), begin, box, depth));
+		if (onLeaf) onLeaf(outTiles.back());
+		TaskAdvance(ctl, (uint64_t)numPoints);
+		return leafIndex;
+	}
+
+	// 非叶子节点：最长轴中位数就地二分
+	KDPoint* mid = PartitionMedianAxisKD(first, last, LongestAxis(box));
+	const std::size_t split = begin + (std::size_t)(mid - first);
+
+	ColumnTile node;
+	node.Depth = depth;
+	node.BBox = box;
+	node.OrderOffset = begin;
+	node.OrderCount = end - begin;
+
+	const int nodeIndex = (int)outTiles.size();
+	outTiles.push_back(std::move(node));
+
+	const std::size_t ranges[2][2] = { { begin, split }, { split, end } };
+	for (const auto& r : ranges)
+	{
+		const Bnd_Box cbox = ComputeBBoxKD(pts.data() + r[0], pts.data() + r[1]);
+		const int childIndex = buildKDRecursive(columns, pts, r[0], r[1], cbox,
+			depth + 1, params, outTiles, ctl, onLeaf);
+		if (childIndex < 0)
+			continue;
+		outTiles[childIndex].Parent = nodeIndex;
+		outTiles[nodeIndex].Children.push_back(childIndex);
+	}
+
+	return nodeIndex;
+}
+
+void CloudTilingColumns::BuildKDTree(
+	const CloudColumns& columns,
+	std::vector<ColumnTile>& outTiles,
+	TilingStatsColumns& stats,
+	const TilingParams& params,
+	CloudTaskControl* ctl,
+	const TileLeafCallback& onLeaf)
+{
+	outTiles.clear();
+	stats = {};
+
+	const Column3f& pos = columns.Position;
+	if (!pos.IsValid())
+		return;
+
+	const std::size_t n = pos.Count;
+	TaskBegin(ctl, CloudTaskStage::Tile, n);
+
+	// 唯一的一份工作数组（坐标 + 全局索引），只在开头从列里取一次；
+	// 递归中各节点只持有 [begin, end)，nth_element 就地重排，不为子节点复制
+	std::vector<KDPoint> pts(n);
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		pos.Get(i, pts[i].P[0], pts[i].P[1], pts[i].P[2]);
+		pts[i].Id = (int)i;
+	}
+
+	const Bnd_Box rootBox = ComputeBBoxKD(pts.data(), pts.data() + n);
+
+	buildKDRecursive(columns, pts, 0, n, rootBox, 0, params, outTiles, ctl, onLeaf);
+
+	stats.NumTiles = (int)outTiles.size();
+	stats.TotalPoints = n;
+}
+
+int CloudTilingColumns::buildMortonRecursive(
+	const CloudColumns& columns,
+	const std::vector<uint64_t>& codes,
+	const std::vector<int>& idx,
+	std::size_t begin,
+	std::size_t end,
+	int depth,
+	const TilingParams& params,
+	std::vector<ColumnTile>& outTiles,
+	CloudTaskControl* ctl,
+	const TileLeafCallback& onLeaf)
+{
+	if (begin >= end) return -1;
+	if (TaskCancelled(ctl)) return -1;
+
+	// params 由 BuildMorton 换算过：MaxDepth 已计入 LeafMinSize，这里不用节点包围盒
+	const std::size_t numPoints = end - begin;
+	Bnd_Box noBox;
+	noBox.SetVoid();
+	if (depth >= kMortonBits || StopSplit((int)numPoints, depth, noBox, params))
+	{
+		// 叶子：Indices 就是排好序的区间，BBox 由 MakeLeafTile 按点重算
+		const int leafIndex = (int)outTiles.size();
+		outTiles.push_back(MakeLeafTile(columns,
+			std::vector<int>(idx.begin() + begin, idx.begin() + end), begin, noBox, depth));
+		if (onLeaf) onLeaf(outTiles.back());
+		TaskAdvance(ctl, numPoints);
+		return leafIndex;
+	}
+
+	ColumnTile node;
+	node.Depth = depth;
+	node.BBox.SetVoid();
+	node.OrderOffset = begin;
+	node.OrderCount = numPoints;
+
+	const int nodeIndex = (int)outTiles.size();
+	outTiles.push_back(std::move(node));
+
+	// 本节点的点共享高 3 * depth 位，下一个 3 位段就是八分码；区间内按它有序，二分找各子块的边界
+	const int shift = 3 * (kMortonBits - 1 - depth);
+	const uint64_t* first = codes.data() + begin;
+	const uint64_t* last = codes.data() + end;
+	std::size_t start[9];
+	start[0] = 0;
+	const uint64_t* lo = first;
+	for (int k = 0; k < 8; ++k)
+	{
+		lo = std::partition_point(lo, last,
+			[shift, k](uint64_t c) { return (int)((c >> shift) & 7) <= k; });
+		start[k + 1] = (std::size_t)(lo - first);
+	}
+
+	int group[9];
+	const int numGroups = GroupOctants(start, params, group);
+	for (int g = 0; g < numGroups; ++g)
+	{
+		const int childIndex = buildMortonRecursive(columns, codes, idx,
+			begin + start[group[g]], begin + start[group[g + 1]],
+			depth + 1, params, outTiles, ctl, onLeaf);
+		if (childIndex < 0)
+			continue;
+		outTiles[childIndex].Parent = nodeIndex;
+		outTiles[nodeIndex].Children.push_back(childIndex);
+		// 内部节点的紧包围盒 = 子节点包围盒的并
+		outTiles[nodeIndex].BBox.Add(outTiles[childIndex].BBox);
+	}
+
+	return nodeIndex;
+}
+
+void CloudTilingColumns::BuildMorton(
+	const CloudColumns& columns,
+	std::vector<ColumnTile>& outTiles,
+	TilingStatsColumns& stats,
+	const TilingParams& params,
+	CloudTaskControl* ctl,
+	const TileLeafCallback& onLeaf)
+{
+	outTiles.clear();
+	stats = {};
+
+	const Column3f& pos = columns.Position;
+	if (!pos.IsValid())
+		return;
+
+	const std::size_t n = pos.Count;
+	TaskBegin(ctl, CloudTaskStage::Tile, n);
+
+	// 根包围盒：顺序读一遍列
+	Standard_Real xmin = 0, ymin = 0, zmin = 0, xmax = 0, ymax = 0, zmax = 0;
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		Standard_Real x, y, z;
+		pos.Get(i, x, y, z);
+		if (i == 0) { xmin = xmax = x; ymin = ymax = y; zmin = zmax = z; continue; }
+		xmin = std::min(xmin, x); xmax = std::max(xmax, x);
+		ymin = std::min(ymin, y); ymax = std::max(ymax, y);
+		zmin = std::min(zmin, z); zmax = std::max(zmax, z);
+	}
+
+	// 每轴量化到 [0, 2^21)，再交织成码；还是顺序读列
+	const double cells = (double)(1u << kMortonBits);
+	const double maxCell = cells - 1.0;
+	const double sx = xmax > xmin ? cells / (xmax - xmin) : 0.0;
+	const double sy = ymax > ymin ? cells / (ymax - ymin) : 0.0;
+	const double sz = zmax > zmin ? cells / (zmax - zmin) : 0.0;
+
+	std::vector<uint64_t> codes(n);
+	std::vector<int> idx(n);
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		Standard_Real x, y, z;
+		pos.Get(i, x, y, z);
+		const uint64_t qx = (uint64_t)std::min((x - xmin) * sx, maxCell);
+		const uint64_t qy = (uint64_t)std::min((y - ymin) * sy, maxCell);
+		const uint64_t qz = (uint64_t)std::min((z - zmin) * sz, maxCell);
+		codes[i] = MortonSpread21(qx) | (MortonSpread21(qy) << 1) | (MortonSpread21(qz) << 2);
+		idx[i] = (int)i;
+	}
+	if (TaskCancelled(ctl))
+		return;
+
+	// 格子是根包围盒的规则细分，第 d 层边长 = 根最长边 / 2^d：LeafMinSize 直接换算成深度上限
+	int levels = std::max(0, std::min(params.MaxDepth, kMortonBits));
+	if (params.LeafMinSize > 0.0)
+	{
+		double edge = std::max(xmax - xmin, std::max(ymax - ymin, zmax - zmin));
+		levels = 0;
+		while (levels < kMortonBits && edge >= 2.0 * params.LeafMinSize)
+		{
+			edge *= 0.5;
+			++levels;
+		}
+	}
+	TilingParams mortonParams = params;
+	mortonParams.MaxDepth = levels;
+	mortonParams.LeafMinSize = 0.0;
+
+	MortonRadixSort(codes, idx, 3 * levels);
+	if (TaskCancelled(ctl))
+		return;
+
+	buildMortonRecursive(columns, codes, idx, 0, n, 0, mortonParams, outTiles, ctl, onLeaf);
+
+	stats.NumTiles = (int)outTiles.size();
+	stats.TotalPoints = n;
+}
+
+void CloudTilingColumns::Build(
+	const CloudColumns& columns,
+	std::vector<ColumnTile>& outTiles,
+	TilingStatsColumns& stats,
+	const TilingParams& params,
+	CloudTaskControl* ctl,
+	const TileLeafCallback& onLeaf)
+{
+	if (params.Scheme == TilingScheme::KDTree)
+		BuildKDTree(columns, outTiles, stats, params, ctl, onLeaf);
+	else if (params.Scheme == TilingScheme::Morton)
+		BuildMorton(columns, outTiles, stats, params, ctl, onLeaf);
+	else
+		BuildOctree(columns, outTiles, stats, params, ctl, onLeaf);
+
+	for (const ColumnTile& t : outTiles)
+	{
+		if (!t.Children.empty()) continue;
+		int bin = 0;
+		for (std::size_t c = t.Indices.size(); c > 1 && bin + 1 < TilingStatsColumns::kLeafHistBins; c >>= 1)
+			++bin;
+		++stats.NumLeaves;
+		++stats.LeafPointsHist[bin];
+	}
+}
+
+void CloudTilingColumns::AssignOrderRanges(std::vector<ColumnTile>& tiles)
+{
+	// tiles 是 DFS 先序：叶子依次排开，内部节点覆盖其全部子节点
+	std::size_t cursor = 0;
+	for (ColumnTile& t : tiles)
+	{
+		if (!t.Children.empty()) continue;
+		t.OrderOffset = cursor;
+		t.OrderCount = t.Indices.size();
+		cursor += t.OrderCount;
+	}
+
+	for (std::size_t i = tiles.size(); i-- > 0; )
+	{
+		ColumnTile& t = tiles[i];
+		if (t.Children.empty()) continue;
+		t.OrderOffset = tiles[t.Children.front()].OrderOffset;
+		t.OrderCount = 0;
+		for (int c : t.Children)
+			t.OrderCount += tiles[c].OrderCount;
+	}
+}
@@ -2,50 +2,141 @@
 #pragma once
 #include "CloudColumns.hxx"
 #include "ColumnTile.hxx"
+#include "CloudTask.hxx"
+#include <functional>
+
+// 空间划分方式
+enum class TilingScheme : int
+{
+	Octree = 0,   // 包围盒中心八分，适合各向均匀的点云
+	KDTree,       // 最长轴中位数二分，叶子点数均衡，适合走廊 / 立面这类狭长扫描
+	Morton,       // 63 位 Morton 码基数排序后按码前缀切分（线性八叉树），划分顺序即 Morton 顺序
+};
 
 struct TilingParams
 {
 	int LeafMaxPoints = 4096;
-	int MaxDepth = 12;
+	int LeafMinPoints = 0;        // 相邻兄弟八分都不到这个点数时合并成一个叶子（合并后不超过 LeafMaxPoints）；0 = 不合并，KD 不用
+	double LeafMinSize = 0.0;     // 节点最长边小于 2 * LeafMinSize 就不再分（世界单位）；> 0 时 MaxDepth 不再限制，深度只受它和 21 层约束
+	int MaxDepth = 12;            // KD 树按二分计，允许 3 * MaxDepth 层（一层八叉相当于三次二分）
+	TilingScheme Scheme = TilingScheme::Octree;
+	int Threads = 0;              // 八叉划分（及 BuildCloudTileSet 里各 tile 的 LOD）的线程数：0 = 按硬件并发数，1 = 串行；结果与线程数无关
 };
 
 struct TilingStatsColumns
 {
+	static constexpr int kLeafHistBins = 24;
+
 	int         NumTiles = 0;
 	std::size_t TotalPoints = 0;
+	int         NumLeaves = 0;
+	int         LeafPointsHist[kLeafHistBins] = {};   // 叶子点数直方图：第 b 格是 [2^b, 2^(b+1))，由 Build 统计
 };
 
+// 叶子完成回调（流式划分用）：参数是刚加入 outTiles 的叶子，可就地补 LOD；
+// 引用只在回调内有效（outTiles 之后还会扩容）。并行划分时会在多个线程上同时回调，顺序不定
+using TileLeafCallback = std::function<void(ColumnTile& leaf)>;
+
 // 基于 CloudColumns 的 AoS+SoA 视图，构建 ColumnTile 八叉树/KD树 叶子
 class CloudTilingColumns
 {
 public:
 	// 直接用 CloudColumns（而不是 CloudDataStore）
+	// 只在一份索引缓冲上就地划分；每个节点的 OrderOffset / OrderCount 是它在这份缓冲（划分顺序）中的区间
+	// params.Threads > 1 时：顶层逐层并行分裂（同层节点并行，大节点再分段协作划分），点数降到一定规模的子树
+	// 作为任务分给各线程，各建一份独立的 tile 缓冲，最后按 DFS 位置拼回 outTiles 并改写下标，结果与串行逐字节相同
+	// ctl 可空：按已落入叶子的点数汇报 Tile 阶段进度；取消后 outTiles 不完整，调用方应丢弃
+	// onLeaf 可空：每个叶子生成后立即回调（串行时为 DFS 顺序）
 	static void BuildOctree(
 		const CloudColumns& columns,
 		std::vector<ColumnTile>& outTiles,
 		TilingStatsColumns& stats,
-		const TilingParams& params);
+		const TilingParams& params,
+		CloudTaskControl* ctl = nullptr,
+		const TileLeafCallback& onLeaf = nullptr);
 
+	// 输出约定与 BuildOctree 相同：DFS 先序，内部节点只有 BBox / Children，叶子带 Indices + LOD0
+	// 整个划分只在一份共享工作数组（KDPoint）上就地 nth_element，不为子节点复制索引
 	static void BuildKDTree(
 		const CloudColumns& columns,
 		std::vector<ColumnTile>& outTiles,
 		TilingStatsColumns& stats,
-		const TilingParams& params);
+		const TilingParams& params,
+		CloudTaskControl* ctl = nullptr,
+		const TileLeafCallback& onLeaf = nullptr);
+
+	// 线性八叉树：根包围盒上每轴 21 位量化、交织成 63 位 Morton 码，LSD 基数排序一次；
+	// 节点 = 共享码前缀的连续区间，子节点区间在排好序的码上二分查找得到，不再逐层搬运索引。
+	// 八分格取根包围盒的规则细分（不是各节点紧包围盒的中心），深度不超过 min(MaxDepth, 21)；
+	// LeafMinSize > 0 时改为格子边长首次小于 2 * LeafMinSize 的那一层。
+	// 输出约定与 BuildOctree 相同；叶子依次拼起来就是全部点的 Morton 顺序
+	static void BuildMorton(
+		const CloudColumns& columns,
+		std::vector<ColumnTile>& outTiles,
+		TilingStatsColumns& stats,
+		const TilingParams& params,
+		CloudTaskControl* ctl = nullptr,
+		const TileLeafCallback& onLeaf = nullptr);
+
+	// 按 params.Scheme 选 BuildOctree / BuildKDTree / BuildMorton，并统计叶子点数直方图
+	static void Build(
+		const CloudColumns& columns,
+		std::vector<ColumnTile>& outTiles,
+		TilingStatsColumns& stats,
+		const TilingParams& params,
+		CloudTaskControl* ctl = nullptr,
+		const TileLeafCallback& onLeaf = nullptr);
+
+	// 按 DFS 先序的层级重新填 OrderOffset / OrderCount（如从 .octiles 读回后）
+	static void AssignOrderRanges(std::vector<ColumnTile>& tiles);
+
+	// KD 划分的工作数组元素：坐标连续存放，选择 / 求 BBox 时不用回列里随机取
+	struct KDPoint
+	{
+		Standard_Real P[3];
+		int           Id;    // 全局 SoA 下标
+	};
 
 private:
+	// idx[begin, end) 是本节点的点，递归中就地重排；codes / scratch 的 [begin, end) 是本节点的划分暂存
+	// 不同节点的区间互不相交，可以在不同线程上同时递归
 	static int buildOctreeRecursive(
 		const CloudColumns& columns,
-		const std::vector<int>& inIdx,
+		std::vector<int>& idx,
+		std::vector<uint8_t>& codes,
+		std::vector<int>& scratch,
+		std::size_t begin,
+		std::size_t end,
 		const Bnd_Box& inBox,
 		int depth,
 		const TilingParams& params,
-		std::vector<ColumnTile>& outTiles);
+		std::vector<ColumnTile>& outTiles,
+		CloudTaskControl* ctl,
+		const TileLeafCallback& onLeaf);
 
-	static void buildKDRecursive(
+	// codes / idx 已按 Morton 码排序，[begin, end) 是本节点的点（共享同一码前缀）
+	static int buildMortonRecursive(
 		const CloudColumns& columns,
-		std::vector<int>& inOutIdx,
+		const std::vector<uint64_t>& codes,
+		const std::vector<int>& idx,
+		std::size_t begin,
+		std::size_t end,
+		int depth,
+		const TilingParams& params,
+		std::vector<ColumnTile>& outTiles,
+		CloudTaskControl* ctl,
+		const TileLeafCallback& onLeaf);
+
+	// pts[begin, end) 是本节点的点，递归中就地重排
+	static int buildKDRecursive(
+		const CloudColumns& columns,
+		std::vector<KDPoint>& pts,
+		std::size_t begin,
+		std::size_t end,
 		const Bnd_Box& inBox,
 		int depth,
 		const TilingParams& params,
-		std::vector<ColumnTile>& outTiles);
+		std::vector<ColumnTile>& outTiles,
+		CloudTaskControl* ctl,
+		const TileLeafCallback& onLeaf);
 };
@@ -16,11 +16,19 @@ struct Column3f
 	const Standard_Real* Y = nullptr;
 	const Standard_Real* Z = nullptr;
 
-	// ӳ䡣Ϊ nullptr˵ 0..Count-1 ˳
+	// float32 մ洢ӵУX/Y/Z Ϊʱʹã = Origin + FX[i]
+	const float* FX = nullptr;
+	const float* FY = nullptr;
+	const float* FZ = nullptr;
+	Standard_Real Origin[3] = { 0.0, 0.0, 0.0 };
+
+	// ӳ䡣Ϊ nullptr˵ First + i * Stride ʣĬϼ 0..Count-1 ˳ʣ
 	const int* Indices = nullptr;
+	std::size_t  First = 0;
+	std::size_t  Stride = 1;
 
 	//	ͼеԪ
-	//	denseʱ = ȫֵIndicesʱ = ͼ鳤
+	//	denseʱ = ȫֵIndicesʱ = ͼ鳤ȣʱ = Ԫ
 	std::size_t  Count = 0;
 
 	Column3f()
@@ -33,12 +41,51 @@ struct Column3f
 
 	bool IsValid() const
 	{
-		return X != nullptr && Y != nullptr && Z != nullptr && Count > 0;
+		return ((X != nullptr && Y != nullptr && Z != nullptr) || IsFloat()) && Count > 0;
+	}
+
+	bool IsFloat() const
+	{
+		return FX != nullptr && FY != nullptr && FZ != nullptr;
+	}
+
+	// ȡ洢± gi ֵ Indicesdouble / float32 ִ洢ͳһ
+	void Get(std::size_t gi, Standard_Real& x, Standard_Real& y, Standard_Real& z) const
+	{
+		if (X)
+		{
+			x = X[gi]; y = Y[gi]; z = Z[gi];
+		}
+		else
+		{
+			x = Origin[0] + FX[gi]; y = Origin[1] + FY[gi]; z = Origin[2] + FZ[gi];
+		}
+	}
+
+	Standard_Real Get(std::size_t gi, int axis) const
+	{
+		if (X)
+			return axis == 0 ? X[gi] : (axis == 1 ? Y[gi] : Z[gi]);
+		return axis == 0 ? Origin[0] + FX[gi] : (axis == 1 ? Origin[1] + FY[gi] : Origin[2] + FZ[gi]);
+	}
+
+	// ֻ洢ָ루X/Y/Z  FX/FY/FZ + OriginIndices / Count ɵ÷
+	void BindStorage(const Column3f& src)
+	{
+		X = src.X; Y = src.Y; Z = src.Z;
+		FX = src.FX; FY = src.FY; FZ = src.FZ;
+		Origin[0] = src.Origin[0]; Origin[1] = src.Origin[1]; Origin[2] = src.Origin[2];
 	}
 
 	bool IsDense() const
 	{
-		return Indices == nullptr;
+		return Indices == nullptr && First == 0 && Stride == 1;
+	}
+
+	// ͼ i ԪصĴ洢±꣨ Indices 䣩
+	std::size_t Index(std::size_t i) const
+	{
+		return Indices ? (std::size_t)Indices[i] : First + i * Stride;
 	}
 
 	char* AttrSemanticToString(AttrSemantic semantic) const
@@ -64,7 +111,53 @@ struct Column3f
 
 		const int max_print = (int)Count < 10 ? Count : 10;
 		for (int i = 0; i < max_print; ++i) {
-			printf("\t(%f, %f, %f)\n", X[i], Y[i], Z[i]);
+			Standard_Real x, y, z;
+			Get(i, x, y, z);
+			printf("\t(%f, %f, %f)\n", x, y, z);
+		}
+	}
+};
+
+// Уɫ / ǿ /  / ûУֻͼԪͼ AttrLayoutOf
+struct ColumnAttr
+{
+	AttrSemantic Semantic = AttrSemantic::User0;
+	AttrLayout   Layout;
+
+	// 洢ÿ Layout.Components ӵУ
+	const void* Data = nullptr;
+
+	// ӳ / 䣬ͬ Column3f::Indices / First / Stride
+	const int* Indices = nullptr;
+	std::size_t First = 0;
+	std::size_t Stride = 1;
+
+	std::size_t Count = 0;
+
+	bool IsValid() const { return Data != nullptr && Count > 0; }
+	bool IsDense() const { return Indices == nullptr && First == 0 && Stride == 1; }
+	std::size_t Index(std::size_t i) const { return Indices ? (std::size_t)Indices[i] : First + i * Stride; }
+
+	//  Layout.Type ȡԭʼ
+	template <class T>
+	const T* As() const { return static_cast<const T*>(Data); }
+
+	// ȡ洢± gi  c  Indicesͳһת double
+	Standard_Real Get(std::size_t gi, int c = 0) const
+	{
+		const std::size_t k = gi * (std::size_t)Layout.Components + (std::size_t)c;
+		switch (Layout.Type) {
+		case AttrType::UInt8:  return As<uint8_t>()[k];
+		case AttrType::UInt16: return As<uint16_t>()[k];
+		default:               return As<float>()[k];
 		}
 	}
+
+	// ֻʹ洢ָ룬Indices / Count ɵ÷
+	void BindStorage(const ColumnAttr& src)
+	{
+		Semantic = src.Semantic;
+		Layout = src.Layout;
+		Data = src.Data;
+	}
 };
\ No newline at end of file
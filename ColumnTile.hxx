@@ -1,10 +1,12 @@
 // ColumnTile.hxx
 #pragma once
 #include "Column.hxx"
+#include "TileQuant.hxx"
 #include <vector>
 #include <Bnd_Box.hxx>
 #include <Standard_Real.hxx>
 #include <Graphic3d_ArrayOfPoints.hxx>
+#include <Graphic3d_Group.hxx>
 
 struct TileLODLevel
 {
@@ -13,9 +15,18 @@ struct TileLODLevel
 	Column3f Position;
 	Column3f Normal;
 
+	// 附加属性视图，与 Position 共用 Indices；对应属性不存在时 Count = 0
+	ColumnAttr Color;
+	ColumnAttr Intensity;
+	ColumnAttr Classification;
+
 	// 当前 LOD 的采样索引（索引的是「全局 SoA 数组」）
 	std::vector<int> Indices;
 
+	// 区间模式（Stride > 0）：Indices 已释放，第 i 个采样点 = First + i * Stride（见 CompactTileIndices）
+	std::size_t First = 0;
+	std::size_t Stride = 0;
+
 	std::size_t PointCount = 0;
 
 	// 世界空间误差（单位 = 模型单位，比如 mm）
@@ -33,7 +44,26 @@ struct TileLODLevel
 
 	bool IsValid() const
 	{
-		return Position.IsValid() && PointCount > 0 && !Indices.empty();
+		return Position.IsValid() && PointCount > 0 && (IsRange() || !Indices.empty());
+	}
+
+	bool IsRange() const { return Stride > 0; }
+
+	// 第 i 个采样点的全局下标
+	int PointIndex(std::size_t i) const
+	{
+		return IsRange() ? (int)(First + i * Stride) : Indices[i];
+	}
+
+	// 索引表：区间模式时展开到 scratch 并返回它，否则直接返回 Indices
+	const std::vector<int>& ExpandIndices(std::vector<int>& scratch) const
+	{
+		if (!IsRange())
+			return Indices;
+		scratch.resize(PointCount);
+		for (std::size_t i = 0; i < PointCount; ++i)
+			scratch[i] = (int)(First + i * Stride);
+		return scratch;
 	}
 
 	void print() const
@@ -59,13 +89,34 @@ struct ColumnTile
 	// 该 tile 在「全局 SoA 数组」中的点索引（全分辨率）
 	std::vector<int> Indices;
 
-	// 所有 LOD 级别
+	// 在划分顺序（叶子按 DFS 依次排开的全部点）中的区间 [OrderOffset, OrderOffset + OrderCount)；
+	// 叶子的 Indices 就是这一段，内部节点覆盖整棵子树
+	std::size_t OrderOffset = 0;
+	std::size_t OrderCount = 0;
+
+	// 点已按划分顺序重排：叶子的 Indices 已释放，点就是全局下标 [OrderOffset, OrderOffset + OrderCount)
+	bool RangeIndices = false;
+
+	// 量化块（CloudTileSetup::Quantize）：LOD0 点序的全部点。非空时 Indices 和各级 LOD 的索引 / 列视图都已释放，
+	// 第 k 级就是块的前 LODs[k].PointCount 个点，GPU 数组和懒生成的 LOD 都从这里来（见 QuantizeTile）
+	TileQuantBlock Quant;
+
+	// 所有 LOD 级别；嵌套：第 k 级是 LOD0 点序的前 LODs[k].PointCount 个点（见 BuildLODLevels）
 	std::vector<TileLODLevel> LODs;
 
-	// 与 LODs 同长度，每个元素对应某一级 LOD 的 GPU 数组
-	std::vector<Handle(Graphic3d_ArrayOfPoints)> LodArrays;
+	// 懒生成（CloudTileSetup::LazyLODs）：应有的 LOD 级数（含 LOD0），大于 LODs.size() 时其余级别待后台补齐
+	int LODsPlanned = 0;
+
+	// 各级 LOD 共用的 GPU 数组，按 LOD0 点序装全部点，画第 k 级时只画前 LODs[k].PointCount 个
+	Handle(Graphic3d_ArrayOfPoints) PointArray;
+
+	// PointArray 实际写入的顶点数（画的顶点数不超过它；SetVertexNumber 之后数组自己的 VertexNumber 已不是这个数）
+	int PointArrayCount = 0;
 
-	// 当前使用哪一个 LOD（索引到 LODs / LodArrays），-1 表示还未选择
+	// 展示里常驻的 group（AIS_Cloud::UpdateTileGroup），装着 PointArray；数组释放或作废时清空，切 LOD 不动它
+	Handle(Graphic3d_Group) Group;
+
+	// 当前使用哪一个 LOD（索引到 LODs），-1 表示还未选择
 	int CurrentLOD = -1;
 
 	// 该 tile 是否参与绘制
@@ -85,9 +136,28 @@ struct ColumnTile
 		return nullptr;
 	}
 
+	// 全分辨率点数（只对叶子有意义）
+	std::size_t NumPoints() const
+	{
+		if (RangeIndices)
+			return OrderCount;
+		return Quant.Empty() ? Indices.size() : Quant.Size();
+	}
+
+	// 全分辨率索引表：区间模式时展开到 scratch 并返回它，否则直接返回 Indices
+	const std::vector<int>& ExpandIndices(std::vector<int>& scratch) const
+	{
+		if (!RangeIndices)
+			return Indices;
+		scratch.resize(OrderCount);
+		for (std::size_t i = 0; i < OrderCount; ++i)
+			scratch[i] = (int)(OrderOffset + i);
+		return scratch;
+	}
+
 	void print() const
 	{
-		printf("Depth %d, PointCount %d\n", /*TileId, */Depth, (int)Indices.size());
+		printf("Depth %d, PointCount %d\n", /*TileId, */Depth, (int)NumPoints());
 		for (const auto& l : LODs)
 			l.print();
 	}
@@ -0,0 +1,309 @@
+// ColumnTileCache.cxx
+#include "ColumnTileCache.hxx"
+#include "ColumnTileLOD.hxx"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+	// 磁盘布局，小端：
+	//
+	//   [TileCacheHeader]
+	//   TileCount 个 { [TileCacheNode][int32 Children...][int32 Indices...]
+	//                  NumLODs 个 { [TileCacheLOD][int32 Indices...] } }
+	//
+	// 记录是紧凑排列的变长流，读取一律 memcpy，不依赖对齐。
+	// 不兼容的布局变更必须提升 kTileCacheVersion。
+	static const char     kTileCacheMagic[8] = { 'O', 'C', 'L', 'D', 'T', 'I', 'L', '\0' };
+	static const uint32_t kTileCacheVersion = 8;   // 3：Parent 指向真正的父节点，内部节点带代表采样 LOD；4：键加入叶子下限参数；5：体素网格采样的 LOD + 实测 ErrorWorld；6：嵌套 LOD，粗级只存点数；7：LOD0 的 ErrorWorld 不再估成最细格子边长；8：体素采样沿 Morton 序抽稀
+
+	struct TileCacheHeader
+	{
+		char     Magic[8];
+		uint32_t Version;
+		uint32_t TileCount;
+		uint64_t PointCount;
+		uint64_t SourceSize;
+		int64_t  SourceMTime;
+		int32_t  LeafMaxPoints;
+		int32_t  MaxDepth;
+		int32_t  MaxLODLevel;
+		uint32_t Flags;          // TileCacheFlags
+		uint32_t PointOrder;     // TileCacheKey::PointOrder
+		int32_t  LeafMinPoints;
+		double   LeafMinSize;
+	};
+	static_assert(sizeof(TileCacheHeader) == 72, "TileCacheHeader layout changed, bump kTileCacheVersion");
+
+	enum TileCacheFlags : uint32_t
+	{
+		TileCache_Float32 = 1u << 0,
+		TileCache_KDTree = 1u << 1,    // 两位都没有 = 八叉划分
+		TileCache_Morton = 1u << 2,
+		TileCache_LazyLODs = 1u << 3,
+	};
+
+	static uint32_t SchemeFlags(TilingScheme scheme)
+	{
+		switch (scheme) {
+		case TilingScheme::KDTree: return TileCache_KDTree;
+		case TilingScheme::Morton: return TileCache_Morton;
+		default:                   return 0u;
+		}
+	}
+
+	struct TileCacheNode
+	{
+		int32_t  Depth;
+		int32_t  Parent;
+		uint32_t NumChildren;
+		uint32_t NumLODs;
+		uint64_t NumIndices;
+		double   BBox[6];        // xmin ymin zmin xmax ymax zmax，IsVoid 时无意义
+		uint32_t BBoxVoid;
+		uint32_t LODsPlanned;    // ColumnTile::LODsPlanned（懒生成），0 = LOD 已建全
+	};
+	static_assert(sizeof(TileCacheNode) == 80, "TileCacheNode layout changed, bump kTileCacheVersion");
+
+	enum TileCacheLODFlags : uint32_t
+	{
+		TileCacheLOD_SharesTileIndices = 1u << 0,   // 索引与 tile.Indices 相同（LOD0），不重复存
+		TileCacheLOD_PrefixOfLOD0 = 1u << 1,        // 索引是 LOD0 的前 PointCount 个（嵌套的粗级），不重复存
+	};
+
+	struct TileCacheLOD
+	{
+		int32_t  Level;
+		uint32_t Flags;
+		uint64_t PointCount;
+		double   ErrorWorld;
+		uint64_t NumIndices;
+	};
+	static_assert(sizeof(TileCacheLOD) == 32, "TileCacheLOD layout changed, bump kTileCacheVersion");
+
+	static bool KeyMatches(const TileCacheHeader& hdr, const TileCacheKey& key)
+	{
+		return hdr.PointCount == key.PointCount
+			&& hdr.SourceSize == key.Source.size
+			&& hdr.SourceMTime == key.Source.mtime
+			&& hdr.LeafMaxPoints == key.LeafMaxPoints
+			&& hdr.LeafMinPoints == key.LeafMinPoints
+			&& hdr.LeafMinSize == key.LeafMinSize
+			&& hdr.MaxDepth == key.MaxDepth
+			&& hdr.MaxLODLevel == key.MaxLODLevel
+			&& ((hdr.Flags & TileCache_Float32) != 0) == key.Float32
+			&& (hdr.Flags & (TileCache_KDTree | TileCache_Morton)) == SchemeFlags(key.Scheme)
+			&& ((hdr.Flags & TileCache_LazyLODs) != 0) == key.LazyLODs
+			&& hdr.PointOrder == key.PointOrder;
+	}
+
+	static bool saveImpl(const std::filesystem::path& path, const TileCacheKey& key,
+		const std::vector<ColumnTile>& tiles)
+	{
+		if (tiles.empty() || key.Source.size == 0) return false;
+
+		TileCacheHeader hdr = {};
+		std::memcpy(hdr.Magic, kTileCacheMagic, sizeof(hdr.Magic));
+		hdr.Version = kTileCacheVersion;
+		hdr.TileCount = (uint32_t)tiles.size();
+		hdr.PointCount = key.PointCount;
+		hdr.SourceSize = key.Source.size;
+		hdr.SourceMTime = key.Source.mtime;
+		hdr.LeafMaxPoints = key.LeafMaxPoints;
+		hdr.LeafMinPoints = key.LeafMinPoints;
+		hdr.LeafMinSize = key.LeafMinSize;
+		hdr.MaxDepth = key.MaxDepth;
+		hdr.MaxLODLevel = key.MaxLODLevel;
+		hdr.Flags = (key.Float32 ? TileCache_Float32 : 0u)
+			| (key.LazyLODs ? TileCache_LazyLODs : 0u)
+			| SchemeFlags(key.Scheme);
+		hdr.PointOrder = key.PointOrder;
+
+		std::filesystem::path tmp = path;
+		tmp += ".tmp";
+		{
+			std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+			if (!out) return false;
+
+			auto writeInts = [&](const std::vector<int>& v) {
+				if (!v.empty())
+					out.write(reinterpret_cast<const char*>(v.data()), (std::streamsize)(v.size() * sizeof(int32_t)));
+			};
+
+			out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+			std::vector<int> tileBuf, lod0Buf, lvlBuf;   // 区间模式（CompactTileIndices）的 tile / LOD 按展开的索引存
+			for (const ColumnTile& tile : tiles)
+			{
+				const std::vector<int>& tileIndices = tile.ExpandIndices(tileBuf);
+				TileCacheNode node = {};
+				node.Depth = tile.Depth;
+				node.Parent = tile.Parent;
+				node.NumChildren = (uint32_t)tile.Children.size();
+				node.NumLODs = (uint32_t)tile.LODs.size();
+				node.LODsPlanned = (uint32_t)std::max(0, tile.LODsPlanned);
+				node.NumIndices = tileIndices.size();
+				node.BBoxVoid = tile.BBox.IsVoid() ? 1u : 0u;
+				if (!node.BBoxVoid)
+					tile.BBox.Get(node.BBox[0], node.BBox[1], node.BBox[2], node.BBox[3], node.BBox[4], node.BBox[5]);
+
+				out.write(reinterpret_cast<const char*>(&node), sizeof(node));
+				writeInts(tile.Children);
+				writeInts(tileIndices);
+
+				const std::vector<int>* lod0 = nullptr;
+				for (const TileLODLevel& lvl : tile.LODs)
+				{
+					const std::vector<int>& lvlIndices = lvl.ExpandIndices(lod0 ? lvlBuf : lod0Buf);
+					TileCacheLOD rec = {};
+					rec.Level = lvl.Level;
+					rec.PointCount = lvl.PointCount;
+					rec.ErrorWorld = lvl.ErrorWorld;
+					if (!lod0 && lvlIndices == tileIndices)
+						rec.Flags |= TileCacheLOD_SharesTileIndices;
+					else if (lod0 && lvlIndices.size() <= lod0->size()
+						&& std::equal(lvlIndices.begin(), lvlIndices.end(), lod0->begin()))
+						rec.Flags |= TileCacheLOD_PrefixOfLOD0;
+					else
+						rec.NumIndices = lvlIndices.size();
+					if (!lod0)
+						lod0 = &lvlIndices;
+
+					out.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+					if (rec.NumIndices)
+						writeInts(lvlIndices);
+				}
+			}
+			out.close();
+			if (out.fail()) { std::error_code ec; std::filesystem::remove(tmp, ec); return false; }
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmp, path, ec);
+		if (ec) { std::filesystem::remove(tmp, ec); return false; }
+		return true;
+	}
+
+	// 顺序读取映射内存，越界即失败
+	struct Reader
+	{
+		const char* p;
+		const char* end;
+
+		template <class T>
+		bool Read(T& v)
+		{
+			if ((std::size_t)(end - p) < sizeof(T)) return false;
+			std::memcpy(&v, p, sizeof(T));
+			p += sizeof(T);
+			return true;
+		}
+
+		// 读 n 个 int32，并校验都落在 [0, limit)
+		bool ReadIndices(uint64_t n, uint64_t limit, std::vector<int>& out)
+		{
+			if (n > (uint64_t)(end - p) / sizeof(int32_t)) return false;
+			out.resize((std::size_t)n);
+			if (n) std::memcpy(out.data(), p, (std::size_t)n * sizeof(int32_t));
+			p += n * sizeof(int32_t);
+			for (int id : out)
+				if (id < 0 || (uint64_t)id >= limit) return false;
+			return true;
+		}
+	};
+
+	static bool loadImpl(const MappedView& mv, const TileCacheKey& key,
+		const CloudColumns& columns, std::vector<ColumnTile>& outTiles)
+	{
+		Reader rd{ mv.data, mv.data + mv.size };
+
+		TileCacheHeader hdr;
+		if (!rd.Read(hdr)) return false;
+		if (std::memcmp(hdr.Magic, kTileCacheMagic, sizeof(hdr.Magic)) != 0
+			|| hdr.Version != kTileCacheVersion
+			|| hdr.TileCount == 0
+			|| !KeyMatches(hdr, key)
+			|| columns.Position.Count != key.PointCount)
+			return false;
+
+		std::vector<ColumnTile> tiles(hdr.TileCount);
+		for (ColumnTile& tile : tiles)
+		{
+			TileCacheNode node;
+			if (!rd.Read(node)) return false;
+			if (node.Parent < -1 || node.Parent >= (int32_t)hdr.TileCount) return false;
+
+			tile.Depth = node.Depth;
+			tile.Parent = node.Parent;
+			if (node.LODsPlanned > 32) return false;
+			tile.LODsPlanned = (int)node.LODsPlanned;
+			tile.BBox.SetVoid();
+			if (!node.BBoxVoid)
+				tile.BBox.Update(node.BBox[0], node.BBox[1], node.BBox[2], node.BBox[3], node.BBox[4], node.BBox[5]);
+
+			if (!rd.ReadIndices(node.NumChildren, hdr.TileCount, tile.Children)) return false;
+			if (!rd.ReadIndices(node.NumIndices, hdr.PointCount, tile.Indices)) return false;
+
+			tile.LODs.resize(node.NumLODs);
+			for (TileLODLevel& lvl : tile.LODs)
+			{
+				TileCacheLOD rec;
+				if (!rd.Read(rec)) return false;
+				lvl.Level = rec.Level;
+				lvl.ErrorWorld = rec.ErrorWorld;
+
+				// 各级共用一份 GPU 数组，粗级必须是 LOD0 的前缀
+				const bool first = &lvl == &tile.LODs.front();
+				if (first != ((rec.Flags & TileCacheLOD_PrefixOfLOD0) == 0)) return false;
+				if (rec.Flags & TileCacheLOD_SharesTileIndices)
+					lvl.Indices = tile.Indices;
+				else if (rec.Flags & TileCacheLOD_PrefixOfLOD0)
+				{
+					const std::vector<int>& lod0 = tile.LODs.front().Indices;
+					if (rec.PointCount > lod0.size()) return false;
+					lvl.Indices.assign(lod0.begin(), lod0.begin() + (std::size_t)rec.PointCount);
+				}
+				else if (!rd.ReadIndices(rec.NumIndices, hdr.PointCount, lvl.Indices))
+					return false;
+
+				lvl.PointCount = (std::size_t)rec.PointCount;
+				if (lvl.PointCount > lvl.Indices.size()) return false;
+				BindLODColumns(columns, lvl);
+			}
+		}
+		if (rd.p != rd.end) return false;
+
+		CloudTilingColumns::AssignOrderRanges(tiles);
+		outTiles = std::move(tiles);
+		return true;
+	}
+} // namespace
+
+bool ColumnTileCache::Save(const std::wstring& path, const TileCacheKey& key,
+	const std::vector<ColumnTile>& tiles)
+{
+	return saveImpl(std::filesystem::path(path), key, tiles);
+}
+bool ColumnTileCache::Save(const std::string& path, const TileCacheKey& key,
+	const std::vector<ColumnTile>& tiles)
+{
+	return saveImpl(std::filesystem::u8path(path), key, tiles);
+}
+
+bool ColumnTileCache::Load(const std::wstring& path, const TileCacheKey& key,
+	const CloudColumns& columns, std::vector<ColumnTile>& outTiles)
+{
+	MappedView mv;
+	if (!mapFile(path, mv)) return false;
+	const bool ok = loadImpl(mv, key, columns, outTiles);
+	mv.close();
+	return ok;
+}
+bool ColumnTileCache::Load(const std::string& path, const TileCacheKey& key,
+	const CloudColumns& columns, std::vector<ColumnTile>& outTiles)
+{
+	MappedView mv;
+	if (!mapFile(path, mv)) return false;
+	const bool ok = loadImpl(mv, key, columns, outTiles);
+	mv.close();
+	return ok;
+}
@@ -0,0 +1,60 @@
+// ColumnTileCache.hxx
+#pragma once
+#include "CloudColumns.hxx"
+#include "ColumnTile.hxx"
+#include "CloudTilingColumns.hxx"
+#include "MappedFile.hxx"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// tile 层级 + 各级 LOD 索引的旁路缓存（.octiles）
+//
+// 保存 BBox / Depth / Parent / Children / tile 索引 / 每级 LOD 的 Level、索引、PointCount、ErrorWorld；
+// Column3f 视图和 GPU 数组不落盘，读回后重新绑定到当前 CloudColumns。
+// 以源文件戳 + 点数 + 点序 + 划分参数作为键，任何一项对不上就视为过期，调用方重建后覆盖写回。
+struct TileCacheKey
+{
+	FileStamp Source;              // 源点云文件（.txt）的大小 / 修改时间
+	uint64_t  PointCount = 0;
+	int       LeafMaxPoints = 0;
+	int       LeafMinPoints = 0;
+	double    LeafMinSize = 0.0;
+	int       MaxDepth = 0;
+	int       MaxLODLevel = 0;
+	bool      Float32 = false;     // 坐标是否为 Float32 存储（八叉划分边界上的舍入可能不同）
+	TilingScheme Scheme = TilingScheme::Octree;
+	uint32_t  PointOrder = 0;      // 索引所对应的点序（CloudDataStore::PointOrder），重排过的点云与原序不通用
+	bool      LazyLODs = false;    // 只存了 LOD0（CloudTileSetup::LazyLODs），与建全 LOD 的缓存不通用
+
+	TileCacheKey() = default;
+	TileCacheKey(const FileStamp& source, const CloudColumns& columns,
+		const TilingParams& params, int maxLODLevel)
+		: Source(source)
+		, PointCount(columns.Position.Count)
+		, LeafMaxPoints(params.LeafMaxPoints)
+		, LeafMinPoints(params.LeafMinPoints)
+		, LeafMinSize(params.LeafMinSize)
+		, MaxDepth(params.MaxDepth)
+		, MaxLODLevel(maxLODLevel)
+		, Float32(columns.Position.IsFloat())
+		, Scheme(params.Scheme)
+	{
+	}
+};
+
+class ColumnTileCache
+{
+public:
+	// 写缓存（先写 .tmp 再改名）；失败不影响已有 tiles
+	static bool Save(const std::wstring& path, const TileCacheKey& key,
+		const std::vector<ColumnTile>& tiles);
+	static bool Save(const std::string& path, const TileCacheKey& key,
+		const std::vector<ColumnTile>& tiles);
+
+	// 读缓存：文件缺失 / 损坏 / 键不匹配都返回 false，且不修改 outTiles
+	static bool Load(const std::wstring& path, const TileCacheKey& key,
+		const CloudColumns& columns, std::vector<ColumnTile>& outTiles);
+	static bool Load(const std::string& path, const TileCacheKey& key,
+		const CloudColumns& columns, std::vector<ColumnTile>& outTiles);
+};
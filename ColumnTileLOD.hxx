@@ -1,8 +1,13 @@
 // ColumnTileLOD.hxx
 #pragma once
 #include "ColumnTile.hxx"
+#include "CloudColumns.hxx"
+#include "CloudTask.hxx"
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
+#include <limits>
+#include <numeric>
 
 // tile İΧжԽ߳ȣ꣩
 inline double TileDiagonal(const ColumnTile& tile)
@@ -15,124 +20,721 @@ inline double TileDiagonal(const ColumnTile& tile)
 	return std::sqrt(dx * dx + dy * dy + dz * dz);
 }
 
-// Ϊÿ ColumnTile ɶ༶ LOD
-// tiles          :  tilesÿ tile  Indices + BBox
-// maxLevel       :  LOD  AIS_Cloud  myMaxLODLevel
-// minPointsPerLOD: ÿ LOD ٶٵ㣨̫ϡ
-// ע⣺ٶ columns.Position / Normal Ѿȫ SoA ݡ
-// ڸ tiles ϻ CloudColumns  LOD 
-inline void BuildLODsForTiles(
-	const CloudColumns& columns,
-	std::vector<ColumnTile>& tiles,
-	int maxLODLevel,
-	float baseWorldError)   // Ŀǰδϸ errorֻռλ
+//  LOD  Position / Normal ͼ󶨵ȫ SoA lvl.Indicesģʽ First / Stride
+// lvl.Indices ·ӻغҪ°
+inline void BindLODColumns(const CloudColumns& columns, TileLODLevel& lvl)
 {
 	const Column3f& pos = columns.Position;
 	const Column3f& nrm = columns.Normal;
 
-	if (!pos.IsValid())
-		return;
+	const int* indices = lvl.IsRange() ? nullptr : lvl.Indices.data();
+	const std::size_t first = lvl.IsRange() ? lvl.First : 0;
+	const std::size_t stride = lvl.IsRange() ? lvl.Stride : 1;
 
-	const bool hasNormal = columns.HasNormal && nrm.IsValid();
+	lvl.Position.Semantic = AttrSemantic::Position;
+	lvl.Position.BindStorage(pos);
+	lvl.Position.Indices = indices;
+	lvl.Position.First = first;
+	lvl.Position.Stride = stride;
+	lvl.Position.Count = lvl.PointCount;
 
-	for (auto& tile : tiles)
+	lvl.Normal.Semantic = AttrSemantic::Normal;
+	if (columns.HasNormal && nrm.IsValid())
 	{
-		if (tile.Indices.empty())
-			continue;
-
-		tile.LODs.clear();
+		lvl.Normal.BindStorage(nrm);
+		lvl.Normal.Indices = indices;
+		lvl.Normal.First = first;
+		lvl.Normal.Stride = stride;
+		lvl.Normal.Count = lvl.PointCount;
+	}
+	else
+	{
+		lvl.Normal.BindStorage(Column3f());
+		lvl.Normal.Indices = nullptr;
+		lvl.Normal.First = 0;
+		lvl.Normal.Stride = 1;
+		lvl.Normal.Count = 0;
+	}
 
-		// -------- LOD0: full resolution --------
-		{
-			TileLODLevel lvl0;
-			lvl0.Level = 0;
+	auto bindAttr = [&](const ColumnAttr& src, ColumnAttr& dst) {
+		dst.BindStorage(src);
+		dst.Indices = src.IsValid() ? indices : nullptr;
+		dst.First = src.IsValid() ? first : 0;
+		dst.Stride = src.IsValid() ? stride : 1;
+		dst.Count = src.IsValid() ? lvl.PointCount : 0;
+	};
+	bindAttr(columns.Color, lvl.Color);
+	bindAttr(columns.Intensity, lvl.Intensity);
+	bindAttr(columns.Classification, lvl.Classification);
+}
 
-			// Position ָȫ SoA
-			lvl0.Position.Semantic = AttrSemantic::Position;
-			lvl0.Position.X = pos.X;
-			lvl0.Position.Y = pos.Y;
-			lvl0.Position.Z = pos.Z;
-			//  tile Ӽ
-			lvl0.Position.Indices = tile.Indices.data();
-			lvl0.Position.Count = tile.Indices.size();
+// һ㣨tile  LOD0ϵ
+//
+// ʱ㰴Χÿ kBits λ Morton һΣ˳ͳ 2 ݱ߳ӵռ
+// ݴ˹"ռԼ target "ر߳Sample ߳ÿȡһ㣬
+// ռƫ target һɾͰľֲά߳ͨһΣ
+// ڿռϾȣɨ˳Ϳնر߳ʵࡣ
+class TileVoxelSampler
+{
+public:
+	static const int kBits = 10;
 
-			if (hasNormal)
+	TileVoxelSampler(const Column3f& pos, const std::vector<int>& base)
+		: base_(base), xyz_(3 * base.size())
+	{
+		// ȡ飬֮ͳƲٻȡ
+		double lo[3] = { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() };
+		double hi[3] = { -lo[0], -lo[1], -lo[2] };
+		for (std::size_t i = 0; i < base.size(); ++i)
+		{
+			double* p = &xyz_[3 * i];
+			pos.Get((std::size_t)base[i], p[0], p[1], p[2]);
+			for (int a = 0; a < 3; ++a)
 			{
-				lvl0.Normal.Semantic = AttrSemantic::Normal;
-				lvl0.Normal.X = nrm.X;
-				lvl0.Normal.Y = nrm.Y;
-				lvl0.Normal.Z = nrm.Z;
-				lvl0.Normal.Indices = tile.Indices.data();
-				lvl0.Normal.Count = tile.Indices.size();
+				lo[a] = std::min(lo[a], p[a]);
+				hi[a] = std::max(hi[a], p[a]);
 			}
-			else
+		}
+		edge_ = 0.0;
+		for (int a = 0; a < 3; ++a)
+		{
+			origin_[a] = base.empty() ? 0.0 : lo[a];
+			edge_ = std::max(edge_, base.empty() ? 0.0 : hi[a] - lo[a]);
+		}
+
+		// 2 ݸռźǰһһͬ 3 λڲ㼰ϸĲһ
+		std::vector<uint32_t> codes(base.size());
+		for (std::size_t i = 0; i < base.size(); ++i)
+			codes[i] = (uint32_t)cellCode_(i, edge_ > 0.0 ? double(1u << kBits) / edge_ : 0.0, (1u << kBits) - 1);
+		radixSort30_(codes);
+		for (int L = 0; L <= kBits; ++L)
+			occupied_[L] = 0;
+		for (std::size_t i = 0; i < codes.size(); ++i)
+		{
+			int L = 0;
+			if (i > 0)
 			{
-				lvl0.Normal.Semantic = AttrSemantic::Normal;
-				lvl0.Normal.X = lvl0.Normal.Y = lvl0.Normal.Z = nullptr;
-				lvl0.Normal.Indices = nullptr;
-				lvl0.Normal.Count = 0;
+				L = kBits + 1;
+				for (uint32_t diff = codes[i] ^ codes[i - 1]; diff != 0; diff >>= 3)
+					--L;
 			}
+			for (int l = L; l <= kBits; ++l)
+				++occupied_[l];
+		}
+	}
 
-			lvl0.Indices = tile.Indices;   // һڵ/չ
-			lvl0.PointCount = lvl0.Indices.size();
-
-			tile.LODs.push_back(std::move(lvl0));
+	// Լ target ռȵ㣨ȫ±꣬ base еȺ˳򣩣ر߳target >= ʱȫ
+	double Sample(std::size_t target, std::vector<int>& out) const
+	{
+		out.clear();
+		if (target >= base_.size())
+		{
+			out = base_;
+			return Spacing(base_.size());
+		}
+		if (target == 0 || edge_ <= 0.0)
+		{
+			if (target > 0)
+				out.push_back(base_.front());
+			return 0.0;
 		}
 
-		// -------- ֵ LOD:  stride  --------
-		const int maxLevel = std::max(0, maxLODLevel);
-		const std::size_t fullCount = tile.Indices.size();
+		// ر߳Сϸӣ겻 21 λ
+		const double minCell = edge_ / double(1u << kBits);
+		double cell = std::max(minCell, Spacing(target * 11 / 10));
 
-		for (int level = 1; level <= maxLevel; ++level)
+		//  -> ĵ㣬Ŷַ = ĸ + 10 = ղۣ
+		struct Slot
 		{
-			// 򵥲ԣstride = 2^level
-			const std::size_t stride = (std::size_t)1 << level;
-			if (stride >= fullCount)
-				break;  // ȥûҪ
+			uint64_t Key;
+			int      Best;     // base ±
+			float    Dist;     // ľƽ
+		};
+		int capBits = 1;
+		while (((std::size_t)1 << capBits) < 2 * base_.size())
+			++capBits;
+		const std::size_t mask = ((std::size_t)1 << capBits) - 1;
+		std::vector<Slot> slots(mask + 1);
 
-			TileLODLevel lvl;
-			lvl.Level = level;
-
-			//  LOD Ĳ
-			lvl.Indices.reserve((fullCount + stride - 1) / stride);
-			for (std::size_t i = 0; i < fullCount; i += stride)
+		std::size_t cells = 0, prevCells = 0;
+		double prevCell = 0.0;
+		for (int iter = 0; iter < 4; ++iter)
+		{
+			for (Slot& s : slots)
+				s.Key = 0;
+			cells = 0;
+			const double inv = 1.0 / cell;
+			for (std::size_t i = 0; i < base_.size(); ++i)
 			{
-				lvl.Indices.push_back(tile.Indices[i]);
+				uint32_t q[3];
+				cellCoords_(i, inv, q);
+				const uint64_t key = ((uint64_t)q[0] | ((uint64_t)q[1] << 21) | ((uint64_t)q[2] << 42)) + 1;
+				std::size_t h = (std::size_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - capBits));
+				while (slots[h].Key != 0 && slots[h].Key != key)
+					h = (h + 1) & mask;
+				Slot& s = slots[h];
+				if (s.Key == 0)
+				{
+					s.Key = key;
+					s.Dist = std::numeric_limits<float>::infinity();
+					++cells;
+				}
+
+				// Ըӵƫƣƽת float ֻȽԶ
+				const double* p = &xyz_[3 * i];
+				double d = 0.0;
+				for (int a = 0; a < 3; ++a)
+				{
+					const double e = p[a] - (origin_[a] + (double(q[a]) + 0.5) * cell);
+					d += e * e;
+				}
+				if ((float)d < s.Dist)
+				{
+					s.Dist = (float)d;
+					s.Best = (int)i;
+				}
 			}
 
-			lvl.PointCount = lvl.Indices.size();
-			if (lvl.PointCount == 0)
+			// ĸȶԶࡢƫ
+			if (cells >= target - target / 16 && cells <= target + target / 4)
+				break;
+			// ռ ~ ߳^-dimһΰռľֲά֮ʵб
+			double dim = dimension_(target);
+			if (prevCells > 0 && prevCells != cells)
+				dim = std::min(3.0, std::max(0.5, std::log(double(cells) / double(prevCells)) / std::log(prevCell / cell)));
+			const double next = std::max(minCell, cell * std::pow(double(cells) / (double(target) * 1.1), 1.0 / dim));
+			if (next == cell)
+				break;
+			prevCell = cell;
+			prevCells = cells;
+			cell = next;
+		}
+
+		// Ӷ target ʱ Morton ɢĸӣڸҲڣ
+		// ڿռϾ̿ߵϡŴغͿն
+		std::vector<std::pair<uint64_t, int>> occupied;
+		occupied.reserve(cells);
+		for (const Slot& s : slots)
+		{
+			if (s.Key == 0)
 				continue;
+			const uint64_t k = s.Key - 1;
+			const uint64_t code = spread_((uint32_t)(k & kMaxCoord))
+				| (spread_((uint32_t)((k >> 21) & kMaxCoord)) << 1)
+				| (spread_((uint32_t)(k >> 42)) << 2);
+			occupied.emplace_back(code, s.Best);
+		}
+		std::sort(occupied.begin(), occupied.end());
 
-			// Position ָȫ SoAIndices ñ LOD 
-			lvl.Position.Semantic = AttrSemantic::Position;
-			lvl.Position.X = pos.X;
-			lvl.Position.Y = pos.Y;
-			lvl.Position.Z = pos.Z;
-			lvl.Position.Indices = lvl.Indices.data();
-			lvl.Position.Count = lvl.PointCount;
+		const double keep = std::min(1.0, double(target) / double(cells));
+		double acc = 0.5;
+		std::vector<uint8_t> chosen(base_.size(), 0);
+		for (const auto& c : occupied)
+		{
+			acc += keep;
+			if (acc >= 1.0)
+			{
+				acc -= 1.0;
+				chosen[(std::size_t)c.second] = 1;
+			}
+		}
+		for (std::size_t i = 0; i < base_.size(); ++i)
+			if (chosen[i])
+				out.push_back(base_[i]);
+		return cell;
+	}
 
-			if (hasNormal)
+	// target ĵͼࣨ絥λռչ target ǲӱ߳
+	// ռ֮ȹľֲά 1 /  2 /  3ֵǡ target 
+	double Spacing(std::size_t target) const
+	{
+		if (target == 0 || edge_ <= 0.0)
+			return 0.0;
+		// ϸռҲ targettarget ӽȫʱмͬ񣩣Ĵռùǲƣ
+		//  LOD0 ᱻϸĸӱ߳ԶСʵ
+		int L = levelFor_(target);
+		if (occupied_[L] < target)
+			L = levelFor_(target / 2);
+		const double cell = edge_ / double(1u << L);
+		return cell * std::pow(double(occupied_[L]) / double(target), 1.0 / dimensionAt_(L));
+	}
+
+private:
+	// ռһδﵽ target Ĳ㣬ȡϸ
+	int levelFor_(std::size_t target) const
+	{
+		for (int L = 0; L < kBits; ++L)
+			if (occupied_[L] >= target)
+				return L;
+		return kBits;
+	}
+
+	double dimension_(std::size_t target) const { return dimensionAt_(levelFor_(target)); }
+
+	double dimensionAt_(int L) const
+	{
+		if (L == 0 || occupied_[L - 1] == 0)
+			return 2.0;
+		return std::min(3.0, std::max(1.0, std::log2(double(occupied_[L]) / double(occupied_[L - 1]))));
+	}
+
+	static const uint32_t kMaxCoord = (1u << 21) - 1;
+
+	//  i ڱ߳Ϊ 1 / inv ϵĸ꣬ÿص maxCoord
+	void cellCoords_(std::size_t i, double inv, uint32_t q[3], uint32_t maxCoord = kMaxCoord) const
+	{
+		const double* p = &xyz_[3 * i];
+		for (int a = 0; a < 3; ++a)
+			q[a] = (uint32_t)std::min((p[a] - origin_[a]) * inv, double(maxCoord));
+	}
+
+	// ڸӵ Morton 루ÿ 21 λ
+	uint64_t cellCode_(std::size_t i, double inv, uint32_t maxCoord) const
+	{
+		uint32_t q[3];
+		cellCoords_(i, inv, q, maxCoord);
+		return spread_(q[0]) | (spread_(q[1]) << 1) | (spread_(q[2]) << 2);
+	}
+
+	// 3 * kBits λ LSD ÿ kBits λ
+	static void radixSort30_(std::vector<uint32_t>& v)
+	{
+		std::vector<uint32_t> tmp(v.size());
+		std::vector<std::size_t> count((std::size_t)1 << kBits);
+		for (int pass = 0; pass < 3; ++pass)
+		{
+			const int shift = pass * kBits;
+			const uint32_t digitMask = (1u << kBits) - 1;
+			std::fill(count.begin(), count.end(), 0);
+			for (uint32_t c : v)
+				++count[(c >> shift) & digitMask];
+			std::size_t sum = 0;
+			for (std::size_t& c : count)
 			{
-				lvl.Normal.Semantic = AttrSemantic::Normal;
-				lvl.Normal.X = nrm.X;
-				lvl.Normal.Y = nrm.Y;
-				lvl.Normal.Z = nrm.Z;
-				lvl.Normal.Indices = lvl.Indices.data();
-				lvl.Normal.Count = lvl.PointCount;
+				const std::size_t k = c;
+				c = sum;
+				sum += k;
 			}
-			else
+			for (uint32_t c : v)
+				tmp[count[(c >> shift) & digitMask]++] = c;
+			v.swap(tmp);
+		}
+	}
+
+	// 21 λ -> ÿλ 2  0
+	static uint64_t spread_(uint64_t v)
+	{
+		v &= 0x1FFFFFull;
+		v = (v | (v << 32)) & 0x1F00000000FFFFull;
+		v = (v | (v << 16)) & 0x1F0000FF0000FFull;
+		v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+		v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+		v = (v | (v << 2)) & 0x1249249249249249ull;
+		return v;
+	}
+
+	const std::vector<int>& base_;
+	std::vector<double>     xyz_;     // base ꣬ÿ 3 
+	double                  origin_[3];
+	double                  edge_ = 0.0;
+	std::size_t             occupied_[kBits + 1];
+};
+
+// LOD0 ϸֵļһ k Լ fullCount / 2^k 㣬2^k СڵͲ
+inline int PlannedLODCount(std::size_t fullCount, int maxLODLevel)
+{
+	int count = 1;
+	for (int level = 1; level <= maxLODLevel; ++level)
+	{
+		if (((std::size_t)1 << level) >= fullCount)
+			break;
+		++count;
+	}
+	return count;
+}
+
+//  base Ϊ LOD0 Ƕ׵Ķ༶ LOD k Լ base.size() / 2^k 㣬ӵ k - 1 TileVoxelSampler
+// Ը𼶰LOD0 ĵ"ּ"ţ k ǡǰ PointCount 㣬
+// һ GPU 飬 LOD ֻĻĶ AIS_Cloud::EnsureTileArray
+//  ErrorWorld = üõر߳ʵࣨLOD0 ռƣ
+inline void BuildLODLevels(const CloudColumns& columns, ColumnTile& tile,
+	const std::vector<int>& base, int maxLODLevel)
+{
+	tile.LODs.clear();
+	if (base.empty())
+		return;
+
+	const std::size_t fullCount = base.size();
+	const int planned = PlannedLODCount(fullCount, maxLODLevel);
+
+	//  base еλã base Ⱥ˳򣩣Լ ErrorWorld
+	std::vector<std::vector<std::size_t>> members(1);
+	std::vector<double> errors(1);
+	members[0].resize(fullCount);
+	for (std::size_t i = 0; i < fullCount; ++i)
+		members[0][i] = i;
+
+	{
+		const TileVoxelSampler sampler(columns.Position, base);
+		errors[0] = sampler.Spacing(fullCount);
+
+		std::vector<int> prev = base, sample;
+		for (int level = 1; level < planned; ++level)
+		{
+			const std::size_t div = (std::size_t)1 << level;
+
+			// һֱ base ϵĲ֮ÿһؽ
+			const double err = level == 1
+				? sampler.Sample((fullCount + div - 1) / div, sample)
+				: TileVoxelSampler(columns.Position, prev).Sample((fullCount + div - 1) / div, sample);
+			if (sample.empty())
+				break;
+
+			// sample  prev Уһ黻 base еλ
+			const std::vector<std::size_t>& up = members.back();
+			std::vector<std::size_t> pos;
+			pos.reserve(sample.size());
+			for (std::size_t j = 0, s = 0; j < up.size() && s < sample.size(); ++j)
 			{
-				lvl.Normal.Semantic = AttrSemantic::Normal;
-				lvl.Normal.X = lvl.Normal.Y = lvl.Normal.Z = nullptr;
-				lvl.Normal.Indices = nullptr;
-				lvl.Normal.Count = 0;
+				if (base[up[j]] == sample[s])
+				{
+					pos.push_back(up[j]);
+					++s;
+				}
 			}
+			members.push_back(std::move(pos));
+			errors.push_back(err);
+			prev.swap(sample);
+		}
+	}
+
+	// ÿּLOD0  = ּĵ㡢δּĵ㡢ڱ base ˳
+	const int numLevels = (int)members.size();
+	std::vector<uint8_t> coarsest(fullCount, 0);
+	for (int level = 1; level < numLevels; ++level)
+		for (std::size_t p : members[level])
+			coarsest[p] = (uint8_t)level;
+
+	std::vector<int> nested;
+	nested.reserve(fullCount);
+	for (int level = numLevels - 1; level >= 0; --level)
+		for (std::size_t i = 0; i < fullCount; ++i)
+			if (coarsest[i] == level)
+				nested.push_back(base[i]);
+
+	tile.LODs.resize(numLevels);
+	for (int level = 0; level < numLevels; ++level)
+	{
+		TileLODLevel& lvl = tile.LODs[level];
+		lvl.Level = level;
+		lvl.PointCount = members[level].size();
+		lvl.Indices.assign(nested.begin(), nested.begin() + lvl.PointCount);
+		lvl.ErrorWorld = errors[level];
+		BindLODColumns(columns, lvl);
+	}
+}
+
+// Ϊ tile ɶ༶ LODLOD0 = ȫ㣬 k Լ 1 / 2^k ĵ㡢ռȲ
+// tile.Indices  LOD0 Ƕ׵֮󰴻˳ŵʱÿһΣģʽ tile 
+// ҶӸջֳͿԵãʽ֣ BuildLODsForTiles ͬ
+inline void BuildTileLODs(const CloudColumns& columns, ColumnTile& tile, int maxLODLevel)
+{
+	std::vector<int> scratch;
+	BuildLODLevels(columns, tile, tile.ExpandIndices(scratch), maxLODLevel);
+	if (!tile.RangeIndices && !tile.LODs.empty())
+		tile.Indices = tile.LODs.front().Indices;
+}
+
+// ɣCloudTileSetup::LazyLODsʱֻ LOD0 = base ȫ㣨ԭ򣩣ֵļ CompleteTileLODs
+// ErrorWorld Ȱ״ƴֹΧΧɵ̯ÿı߳ʱʵֵ
+inline void BuildBaseLOD(const CloudColumns& columns, ColumnTile& tile,
+	const std::vector<int>& base, int maxLODLevel)
+{
+	tile.LODs.clear();
+	tile.LODsPlanned = 0;
+	if (base.empty())
+		return;
+
+	tile.LODs.resize(1);
+	TileLODLevel& lvl0 = tile.LODs.front();
+	lvl0.Level = 0;
+	lvl0.Indices = base;
+	lvl0.PointCount = base.size();
+	lvl0.ErrorWorld = 0.0;
+	if (!tile.BBox.IsVoid())
+	{
+		Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+		tile.BBox.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+		double e[3] = { xmax - xmin, ymax - ymin, zmax - zmin };
+		std::sort(e, e + 3);
+		const double n = (double)base.size();
+		lvl0.ErrorWorld = e[1] > 0.0 ? std::sqrt(e[2] * e[1] / n) : e[2] / n;
+	}
+	BindLODColumns(columns, lvl0);
+	tile.LODsPlanned = PlannedLODCount(base.size(), maxLODLevel);
+}
+
+// ڲڵĴȫ㰴˳ſȲȡԼ samplePoints 
+// Ҷӵ Indices ǡǻ˳е [OrderOffset, OrderOffset + n) AssignOrderRanges
+inline void SampleSubtree(const std::vector<ColumnTile>& tiles, int node,
+	std::size_t samplePoints, std::vector<int>& out)
+{
+	out.clear();
+	const ColumnTile& root = tiles[node];
+	if (samplePoints == 0 || root.OrderCount == 0)
+		return;
+
+	const std::size_t stride = std::max<std::size_t>(1, (root.OrderCount + samplePoints - 1) / samplePoints);
+	out.reserve(root.OrderCount / stride + 1);
 
-			tile.LODs.push_back(std::move(lvl));
+	std::vector<int> stack(root.Children.rbegin(), root.Children.rend());
+	while (!stack.empty())
+	{
+		const ColumnTile& t = tiles[stack.back()];
+		stack.pop_back();
+		if (!t.Children.empty())
+		{
+			stack.insert(stack.end(), t.Children.rbegin(), t.Children.rend());
+			continue;
 		}
 
+		// һڱҶڵĲλ
+		const std::size_t rel = t.OrderOffset - root.OrderOffset;
+		for (std::size_t i = (stride - rel % stride) % stride; i < t.NumPoints(); i += stride)
+			out.push_back(t.RangeIndices ? (int)(t.OrderOffset + i) : t.Indices[i]);
+	}
+}
+
+// Ϊڲڵ㽨 LODPotree ʽĴֲ㣩LOD0 = Լ samplePoints Ĵֵļͬ BuildTileLODs
+// ݴԶֱӻڲڵ̽ҶӣҶӵ LOD samplePoints = 0 ʱ
+// ctl ɿգֻӦȡbaseOnly ʱֻ LOD0BuildBaseLOD
+inline void BuildNodeLODs(
+	const CloudColumns& columns,
+	std::vector<ColumnTile>& tiles,
+	std::size_t samplePoints,
+	int maxLODLevel,
+	CloudTaskControl* ctl = nullptr,
+	bool baseOnly = false)
+{
+	if (!columns.Position.IsValid() || samplePoints == 0)
+		return;
+
+	std::vector<int> sample;
+	for (std::size_t i = 0; i < tiles.size(); ++i)
+	{
+		ColumnTile& tile = tiles[i];
+		if (tile.Children.empty())
+			continue;
+		if (TaskCancelled(ctl))
+			return;
+
+		SampleSubtree(tiles, (int)i, samplePoints, sample);
+		if (baseOnly)
+			BuildBaseLOD(columns, tile, sample, maxLODLevel);
+		else
+			BuildLODLevels(columns, tile, sample, maxLODLevel);
+	}
+}
+
+// Ϊÿ ColumnTile ɶ༶ LOD BuildLODLevels ErrorWorld ʵ
+// tiles          :  tilesÿ tile  Indices + BBox
+// maxLevel       :  LOD  AIS_Cloud::TileSetup().MaxLODLevel
+// ע⣺ٶ columns.Position / Normal Ѿȫ SoA ݡ
+// ctl ɿգѴ tile ĵ㱨 LOD ׶νȣȡ tile  LOD 
+// baseOnlyɣֻ LOD0BuildBaseLOD༶ CompleteTileLODs 貹
+// threads0 = Ӳ1 = У tile ֻдԼ߳޹
+// ڸ tiles ϻ CloudColumns  LOD 
+inline void BuildLODsForTiles(
+	const CloudColumns& columns,
+	std::vector<ColumnTile>& tiles,
+	int maxLODLevel,
+	CloudTaskControl* ctl = nullptr,
+	bool baseOnly = false,
+	int threads = 1)
+{
+	if (!columns.Position.IsValid())
+		return;
+
+	uint64_t total = 0;
+	for (const auto& tile : tiles) total += tile.NumPoints();
+	TaskBegin(ctl, CloudTaskStage::LOD, total);
+
+	auto buildOne = [&](ColumnTile& tile) {
+		if (baseOnly)
+		{
+			std::vector<int> scratch;
+			BuildBaseLOD(columns, tile, tile.ExpandIndices(scratch), maxLODLevel);
+		}
+		else
+			BuildTileLODs(columns, tile, maxLODLevel);
+
 		// debug
 		// tile.print();
+		TaskAdvance(ctl, tile.NumPoints());
+	};
+
+	// ̣߳tile ӴСŶӣ߳ȡһδģͬ˲滮ֵ񣩣
+	// ʱȣ tile ȷȥ߳Կһ tile
+	if (threads <= 0)
+		threads = (int)std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::size_t> order;
+	order.reserve(tiles.size());
+	for (std::size_t i = 0; i < tiles.size(); ++i)
+		if (tiles[i].NumPoints() > 0)
+			order.push_back(i);
+	threads = (int)std::min<std::size_t>((std::size_t)threads, order.size());
+
+	if (threads <= 1)
+	{
+		for (std::size_t i : order)
+		{
+			if (TaskCancelled(ctl))
+				return;
+			buildOne(tiles[i]);
+		}
+		return;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&tiles](std::size_t a, std::size_t b) {
+		return tiles[a].NumPoints() > tiles[b].NumPoints();
+	});
+	std::atomic<std::size_t> next{ 0 };
+	RunOnThreads(threads, [&](int) {
+		for (std::size_t k; (k = next.fetch_add(1)) < order.size(); )
+		{
+			if (TaskCancelled(ctl))
+				return;
+			buildOne(tiles[order[k]]);
+		}
+	});
+}
+
+// Ѱ˳źCloudTileSetup::ReorderPointsҶӵĵһΣLOD0 ͬ
+//  (First, PointCount, Stride) 䲢ͷţ GPU ʱ˳УǵȲԭ
+// ڽ LODд껺֮ã水չ棩ͷŵֽ
+inline std::size_t CompactTileIndices(const CloudColumns& columns, std::vector<ColumnTile>& tiles)
+{
+	// ȲҲΪز 0Ƕ LOD ĸźǴ tile 㿪ʼĲ 1 
+	auto strideOf = [](const std::vector<int>& v) -> std::size_t {
+		if (v.empty() || v[0] < 0) return 0;
+		if (v.size() == 1) return 1;
+		const long long s = (long long)v[1] - v[0];
+		if (s <= 0) return 0;
+		for (std::size_t i = 2; i < v.size(); ++i)
+			if ((long long)v[i] - v[i - 1] != s) return 0;
+		return (std::size_t)s;
+	};
+
+	std::size_t freed = 0;
+	for (ColumnTile& tile : tiles)
+	{
+		if (tile.Children.empty() && !tile.RangeIndices && !tile.Indices.empty()
+			&& tile.Indices.size() == tile.OrderCount
+			&& tile.Indices.front() == (int)tile.OrderOffset && strideOf(tile.Indices) == 1)
+		{
+			freed += tile.Indices.capacity() * sizeof(int);
+			std::vector<int>().swap(tile.Indices);
+			tile.RangeIndices = true;
+		}
+
+		for (TileLODLevel& lvl : tile.LODs)
+		{
+			if (lvl.IsRange() || lvl.Indices.size() != lvl.PointCount)
+				continue;
+			const std::size_t stride = strideOf(lvl.Indices);
+			if (stride == 0)
+				continue;
+
+			lvl.First = (std::size_t)lvl.Indices.front();
+			lvl.Stride = stride;
+			freed += lvl.Indices.capacity() * sizeof(int);
+			std::vector<int>().swap(lvl.Indices);
+			BindLODColumns(columns, lvl);
+		}
+	}
+	return freed;
+}
+
+// λ LOD ȫУͼֻ𡢵ǰ׺ȣ ErrorWorld
+// ErrorWorld ȡԭеĽϴ
+inline void DetachQuantizedLODs(ColumnTile& tile)
+{
+	const Standard_Real qErr = tile.Quant.MaxError();
+	for (TileLODLevel& lvl : tile.LODs)
+	{
+		TileLODLevel bare;
+		bare.Level = lvl.Level;
+		bare.PointCount = lvl.PointCount;
+		bare.ErrorWorld = std::max(lvl.ErrorWorld, qErr);
+		lvl = std::move(bare);
+	}
+}
+
+//  tile  LOD0  16 λ飨ColumnTile::Quantͷȫ±꣺
+// tile.Indices ͸ LOD  k ǿǰ PointCount 㣨Ƕ LOD
+// Ҷӵ LOD0 ȫ㣬ڲڵǴҪд .octiles ֮ãȫ±꣩
+inline void QuantizeTile(const CloudColumns& columns, ColumnTile& tile)
+{
+	tile.Quant.Clear();
+	if (tile.LODs.empty())
+		return;
+
+	const Column3f noNormal;
+	const Column3f& nrm = (columns.HasNormal && columns.Normal.IsValid()) ? columns.Normal : noNormal;
+	std::vector<int> scratch;
+	EncodeTileQuant(columns.Position, nrm, tile.LODs.front().ExpandIndices(scratch), tile.BBox, tile.Quant);
+	if (tile.Quant.Empty())
+		return;
+
+	std::vector<int>().swap(tile.Indices);
+	tile.RangeIndices = false;
+	DetachQuantizedLODs(tile);
+}
+
+//  tile  QuantizeTile֮ tile ٶ store  / У CloudDataStore::ReleaseCoordinates
+// threads0 = Ӳ1 = У tile ֻдԼ
+inline void QuantizeTiles(const CloudColumns& columns, std::vector<ColumnTile>& tiles, int threads = 1)
+{
+	if (!columns.Position.IsValid())
+		return;
+
+	if (threads <= 0)
+		threads = (int)std::max(1u, std::thread::hardware_concurrency());
+	threads = (int)std::min<std::size_t>((std::size_t)threads, tiles.size());
+	std::atomic<std::size_t> next{ 0 };
+	RunOnThreads(std::max(1, threads), [&](int) {
+		for (std::size_t k; (k = next.fetch_add(1)) < tiles.size(); )
+			QuantizeTile(columns, tiles[k]);
+	});
+}
+
+// ɵ LODBuildBaseLOD ֮󣬹 tile.LODsPlanned Ҷͬ BuildTileLODsڲڵLOD0Ͻ
+// LOD0 ĵ֮Ƕ׵ tile  columnsڿľֲϲ鰴µ LOD0 š
+// ڹ̶߳ tile ĸ
+inline void CompleteTileLODs(const CloudColumns& columns, ColumnTile& tile)
+{
+	if (tile.LODs.empty() || (int)tile.LODs.size() >= tile.LODsPlanned)
+		return;
+
+	const int maxLODLevel = tile.LODsPlanned - 1;
+	if (!tile.Quant.Empty())
+	{
+		std::vector<float> x, y, z;
+		CloudColumns local;
+		DecodeTileQuantLocal(tile.Quant, x, y, z, local.Position);
+		std::vector<int> base(tile.Quant.Size());
+		std::iota(base.begin(), base.end(), 0);
+		BuildLODLevels(local, tile, base, maxLODLevel);
+		if (!tile.LODs.empty())
+			tile.Quant.Permute(tile.LODs.front().Indices);
+		DetachQuantizedLODs(tile);
+	}
+	else if (tile.Children.empty())
+		BuildTileLODs(columns, tile, maxLODLevel);
+	else
+	{
+		std::vector<int> scratch;
+		const std::vector<int> base = tile.LODs.front().ExpandIndices(scratch);
+		BuildLODLevels(columns, tile, base, maxLODLevel);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+// FastFloat.hxx
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+// 定点小数（如 123456.789）专用的浮点解析内核，结果与 std::from_chars 逐位一致
+//
+// 快路径：[-]digits[.digits]，总位数 <= 19 且尾数 <= 2^53、小数位 <= 22。
+// 此时尾数和 10^k 都能被 double 精确表示，一次 IEEE 除法即为正确舍入结果，
+// 与 from_chars 的正确舍入结果相同。其余情况（指数、inf/nan、超长尾数等）
+// 一律回退到 std::from_chars。
+struct FastFloat
+{
+	static std::from_chars_result Parse(const char* first, const char* last, double& value)
+	{
+		const char* s = first;
+		const bool neg = (s < last && *s == '-');
+		if (neg) ++s;
+
+		uint64_t mant = 0;
+
+		const char* intBeg = s;
+		s = parseDigits(s, last, mant);
+		const std::ptrdiff_t nInt = s - intBeg;
+
+		std::ptrdiff_t nFrac = 0;
+		if (s < last && *s == '.')
+		{
+			const char* fracBeg = ++s;
+			s = parseDigits(s, last, mant, 19 - nInt);
+			nFrac = s - fracBeg;
+		}
+
+		// 没有数字 / 位数可能溢出 / 带指数：交给通用解析
+		if (nInt + nFrac == 0 || nInt + nFrac > 19 || nFrac > 22)
+			return std::from_chars(first, last, value);
+		if (s < last && (*s == 'e' || *s == 'E'))
+			return std::from_chars(first, last, value);
+		if (mant > (uint64_t(1) << 53))
+			return std::from_chars(first, last, value);
+
+		double d = (double)mant;
+		if (nFrac > 0) d /= kPow10[nFrac];
+		value = neg ? -d : d;
+		return { s, std::errc() };
+	}
+
+private:
+	static bool isDigit(char c) { return (unsigned char)(c - '0') <= 9; }
+
+	// 8 个字节是否全是 '0'..'9'
+	static bool isEightDigits(uint64_t v)
+	{
+		return (((v & 0xF0F0F0F0F0F0F0F0ull) |
+			(((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull);
+	}
+
+	// SWAR：一次把 8 个 ASCII 数字（小端）合成一个整数
+	static uint32_t parseEightDigits(uint64_t v)
+	{
+		const uint64_t mask = 0x000000FF000000FFull;
+		const uint64_t mul1 = 0x000F424000000064ull; // 100 + (1000000 << 32)
+		const uint64_t mul2 = 0x0000271000000001ull; // 1 + (10000 << 32)
+		v -= 0x3030303030303030ull;
+		v = (v * 10) + (v >> 8);
+		v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+		return (uint32_t)v;
+	}
+
+	// 连续数字累加进 mant；maxDigits 之后不再累加（调用方据位数判断是否回退）
+	static const char* parseDigits(const char* s, const char* last, uint64_t& mant,
+		std::ptrdiff_t maxDigits = 19)
+	{
+		const char* beg = s;
+		while (last - s >= 8 && (s - beg) + 8 <= maxDigits)
+		{
+			uint64_t v;
+			std::memcpy(&v, s, 8);
+			if (!isEightDigits(v)) break;
+			mant = mant * 100000000ull + parseEightDigits(v);
+			s += 8;
+		}
+		while (s < last && isDigit(*s))
+		{
+			if (s - beg < maxDigits) mant = mant * 10 + (uint64_t)(*s - '0');
+			++s;
+		}
+		return s;
+	}
+
+	static constexpr double kPow10[23] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+};
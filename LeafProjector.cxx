@@ -41,15 +41,11 @@ Standard_Real LeafProjector::PixelArea(const Bnd_Box& box,
 	return area;
 }
 
-double LeafProjector::PixelDiag(const Handle(V3d_View)& view,
-	const Bnd_Box& box,
+static double pixelDiag(const Handle(V3d_View)& view,
+	Standard_Real xmin, Standard_Real ymin, Standard_Real zmin,
+	Standard_Real xmax, Standard_Real ymax, Standard_Real zmax,
 	int haloPx)
 {
-	if (box.IsVoid()) return 0.0;
-
-	Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
-	box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
-
 	const gp_Pnt corners[8] = {
 	  {xmin,ymin,zmin},{xmax,ymin,zmin},{xmin,ymax,zmin},{xmax,ymax,zmin},
 	  {xmin,ymin,zmax},{xmax,ymin,zmax},{xmin,ymax,zmax},{xmax,ymax,zmax}
@@ -67,7 +63,30 @@ double LeafProjector::PixelDiag(const Handle(V3d_View)& view,
 		maxx = std::max(maxx, (int)ix);
 		maxy = std::max(maxy, (int)iy);
 	}
-	const int dx = (maxx - minx) + 2 * haloPx;
-	const int dy = (maxy - miny) + 2 * haloPx;
-	return std::sqrt(double(dx * dx + dy * dy));
+	// 放大后根节点的投影可达数万像素，平方用 double 免得溢出成负数
+	const double dx = double(maxx) - double(minx) + 2.0 * haloPx;
+	const double dy = double(maxy) - double(miny) + 2.0 * haloPx;
+	return std::sqrt(dx * dx + dy * dy);
+}
+
+double LeafProjector::PixelDiag(const Handle(V3d_View)& view,
+	const Bnd_Box& box,
+	int haloPx)
+{
+	if (box.IsVoid()) return 0.0;
+
+	Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+	box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+	return pixelDiag(view, xmin, ymin, zmin, xmax, ymax, zmax, haloPx);
+}
+
+double LeafProjector::PixelDiag(const Handle(V3d_View)& view,
+	const float* box,
+	const double origin[3],
+	int haloPx)
+{
+	if (box[0] > box[3]) return 0.0;
+	return pixelDiag(view,
+		origin[0] + box[0], origin[1] + box[1], origin[2] + box[2],
+		origin[0] + box[3], origin[1] + box[4], origin[2] + box[5], haloPx);
 }
\ No newline at end of file
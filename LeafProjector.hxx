@@ -13,6 +13,12 @@ struct LeafProjector
 		const Bnd_Box& box,
 		int haloPx = 0);
 
+	//! ͬϣΧΪ origin  float[6]xmin ymin zmin xmax ymax zmaxxmin > xmax ʾպУ TileNodeArray
+	static double PixelDiag(const Handle(V3d_View)& view,
+		const float* box,
+		const double origin[3],
+		int haloPx = 0);
+
 	static Standard_Real LeafProjector::PixelArea(const Bnd_Box& box,
 		const opencascade::handle<V3d_View>& view);
 };
\ No newline at end of file
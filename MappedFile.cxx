@@ -35,11 +35,24 @@ bool mapFile(const std::wstring& path, MappedView& out) {
 	out.size = static_cast<size_t>(sz.QuadPart);
 	return true;
 }
-bool mapFile(const std::string& path, MappedView& out) {
+static std::wstring utf8ToWide(const std::string& path) {
 	int wlen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
 	std::wstring w; w.resize(wlen ? wlen - 1 : 0);
 	if (wlen) MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, w.data(), wlen);
-	return mapFile(w, out);
+	return w;
+}
+bool mapFile(const std::string& path, MappedView& out) {
+	return mapFile(utf8ToWide(path), out);
+}
+bool statFile(const std::wstring& path, FileStamp& out) {
+	WIN32_FILE_ATTRIBUTE_DATA fad;
+	if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &fad)) return false;
+	out.size = (uint64_t(fad.nFileSizeHigh) << 32) | fad.nFileSizeLow;
+	out.mtime = (int64_t(fad.ftLastWriteTime.dwHighDateTime) << 32) | fad.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+bool statFile(const std::string& path, FileStamp& out) {
+	return statFile(utf8ToWide(path), out);
 }
 #else
 bool mapFile(const std::string& path, MappedView& out) {
@@ -54,4 +67,11 @@ bool mapFile(const std::string& path, MappedView& out) {
 	return true;
 }
 bool mapFile(const std::wstring& /*path*/, MappedView& /*out*/) { return false; } //  Windows ʵ
+bool statFile(const std::string& path, FileStamp& out) {
+	struct stat st; if (::stat(path.c_str(), &st) != 0) return false;
+	out.size = static_cast<uint64_t>(st.st_size);
+	out.mtime = static_cast<int64_t>(st.st_mtime);
+	return true;
+}
+bool statFile(const std::wstring& /*path*/, FileStamp& /*out*/) { return false; }
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 // MappedFile.hxx
 #pragma once
 #include <cstddef>
+#include <cstdint>
 #include <string>
 
 struct MappedView {
@@ -10,4 +11,15 @@ struct MappedView {
 };
 
 bool mapFile(const std::wstring& path, MappedView& out); // Windows
-bool mapFile(const std::string& path, MappedView& out); // POSIX ҲṩխִWindows ͬ
\ No newline at end of file
+bool mapFile(const std::string& path, MappedView& out); // POSIX ҲṩխִWindows ͬ
+
+// ļС + ޸ʱ䣬жϻ/·ļǷ
+struct FileStamp {
+	uint64_t size = 0;
+	int64_t  mtime = 0;  // ƽ̨صʱ̶ȣֻȱȽ
+	bool operator==(const FileStamp& o) const { return size == o.size && mtime == o.mtime; }
+	bool operator!=(const FileStamp& o) const { return !(*this == o); }
+};
+
+bool statFile(const std::wstring& path, FileStamp& out); // Windows
+bool statFile(const std::string& path, FileStamp& out);
\ No newline at end of file
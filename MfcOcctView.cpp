@@ -12,9 +12,14 @@
 #include "MfcOcctDoc.h"
 #include "MfcOcctView.h"
 #include "CloudLodController.hxx"
+#include "CloudImport.hxx"
+#include "AIS_Cloud.hxx"
 #include "BRepPrimAPI_MakeBox.hxx"
 #include "SceneHud.hxx"
 
+static const UINT_PTR kImportTimerId = 1002;   // 导入进度轮询
+static const UINT     kImportPollMs = 100;
+
 // CMfcOcctView
 
 IMPLEMENT_DYNCREATE(CMfcOcctView, CView)
@@ -227,6 +232,13 @@ void CMfcOcctView::OnInitialUpdate()
 	myView->SetBgGradientColors(color[0], color[1], Aspect_GradientFillMethod_Horizontal, Standard_True);
 
 	m_lodCtl = std::make_unique<CloudLodController>(myAisContext, myView);
+	{
+		// 按屏幕误差选级：取点间距投影不超过 1 像素的最粗一级
+		CloudLodController::LodThreshold th;
+		th.screenError = true;
+		th.maxErrorPx = 1.0;
+		m_lodCtl->SetThreshold(th);
+	}
 	m_lod.timerId = 1001;   // 自定
 	m_lod.debounceMs = 150;    // 可调
 
@@ -505,7 +517,6 @@ void CMfcOcctView::OnMouseLeave()
 }
 
 #include "CloudDataStore.hxx"
-#include "AIS_Cloud.hxx"
 #include "Geom_RectangularTrimmedSurface.hxx"
 void CMfcOcctView::OnImportTxtCloud()
 {
@@ -518,27 +529,144 @@ void CMfcOcctView::OnImportTxtCloud()
 	// 获取用户选择的文件路径
 	CString filePath = dlg.GetPathName();
 
-	auto store = std::make_shared<CloudDataStore>();
+	// 解析 / 划分 / LOD 都放到后台线程，界面不卡；旁路缓存（.ocb / .octiles）的读写也在后台
+	// 上一次导入还没结束就取消掉（析构时等待工作线程退出），以最新一次为准
+	// 流式：解析时先显示抽样预览，划分时已完成的叶子陆续加入显示
+	// 懒生成 LOD：导入只建 LOD0，更粗的级别在第一次被选中时由后台补齐
+	// 量化：导入完成后 tile 换成 16 位量化块，store 的坐标列随即释放，坐标和法向降到每点约 9 字节
+	CloudImportRequest req;
+	req.Path = std::wstring(filePath);
+	req.Streaming = true;
+	req.Setup.LazyLODs = true;
+	req.Setup.Quantize = true;
+	m_importJob.reset();
+	RemoveStreamingClouds();
+	m_importJob = std::make_unique<CloudImportJob>(std::move(req));
+	m_importJob->Start();
+
+	SetTimer(kImportTimerId, kImportPollMs, nullptr);
+}
+
+void CMfcOcctView::PollImport()
+{
+	if (!m_importJob)
+	{
+		KillTimer(kImportTimerId);
+		return;
+	}
+
+	if (!m_importJob->IsFinished())
+	{
+		PollStreaming();
+		if (m_sceneHud)
+		{
+			static const char* const kStageNames[] = { "Start", "Parse", "Tile", "LOD" };
+			TCollection_AsciiString txt("Importing: ");
+			txt += kStageNames[(int)m_importJob->Stage()];
+			txt += " ";
+			txt += (Standard_Integer)(m_importJob->StageFraction() * 100.0 + 0.5);
+			txt += "%";
+			m_sceneHud->Update(txt);
+			myView->Redraw();
+		}
+		return;
+	}
+
+	KillTimer(kImportTimerId);
+	const CloudImportState state = m_importJob->State();
+	CloudImportResult result = m_importJob->TakeResult();
+	m_importJob.reset();
 
-	// 调用 LoadTxtXYZMapped 加载点云数据
-	// 假设文件每行有 6 列：x y z nx ny nz，XYZ 分别在第 0/1/2 列
-	if (!store->LoadTxtMappedAuto(std::wstring(filePath)))
+	if (state != CloudImportState::Succeeded)
 	{
-		AfxMessageBox(L"加载点云数据失败，请检查文件格式是否正确。");
+		RemoveStreamingClouds();
+		myAisContext->UpdateCurrentViewer();
+		if (state != CloudImportState::Cancelled)
+			AfxMessageBox(L"加载点云数据失败，请检查文件格式是否正确。");
 		return;
 	}
 
-	// 然后交给 AIS_Cloud 使用
-	Handle(AIS_Cloud) cloud = new AIS_Cloud();
-	cloud->SetDataStore(store);
+	// 渲染线程只做 AIS 对象和显示相关的轻量工作
+	// 流式显示过的对象直接换成完整层级（控制器按 TileEpoch 重新同步），预览撤掉
+	Handle(AIS_Cloud) cloud = m_streamCloud;
+	const bool wasStreaming = !cloud.IsNull();
+	m_streamCloud.Nullify();
+	RemoveStreamingClouds();
+	if (!wasStreaming)
+		cloud = new AIS_Cloud();
+	cloud->SetTileSet(result.Store, std::move(result.TileSet));
 	cloud->SetView(myView);
 
-	m_lodCtl->RegisterCloud(cloud);
+	if (!wasStreaming)
+		m_lodCtl->RegisterCloud(cloud);
 	m_lodCtl->Tick();
+	if (m_lodCtl->PendingLODs() > 0)
+		m_lod.Mark(m_hWnd);   // 后台补好的 LOD 要靠下一次 Tick 换进来
+	m_lodCtl->UpdateDisplayedStats();
+	UpdateHud();
 
-	myAisContext->Display(cloud, Standard_False);
+	if (!wasStreaming)
+		myAisContext->Display(cloud, Standard_False);
 	myAisContext->UpdateCurrentViewer();
-	myView->FitAll();
+	if (!wasStreaming)
+		myView->FitAll();
+}
+
+void CMfcOcctView::PollStreaming()
+{
+	// 解析中：预览样本翻倍时换一次预览对象的数据
+	if (std::shared_ptr<CloudDataStore> pv = m_importJob->TakePreview())
+	{
+		const bool first = m_previewCloud.IsNull();
+		if (first)
+		{
+			m_previewCloud = new AIS_Cloud();
+			m_previewCloud->SetView(myView);
+		}
+		m_previewCloud->SetDataStore(pv);   // 换 tile 集，下次 Tick 按 TileEpoch 重新同步
+		if (first)
+		{
+			m_lodCtl->RegisterCloud(m_previewCloud);
+			myAisContext->Display(m_previewCloud, Standard_False);
+		}
+		m_lodCtl->Tick();
+		if (first)
+			myView->FitAll();
+	}
+
+	// 解析完成：用完整 store 建流式对象，之后叶子陆续加入
+	if (m_streamCloud.IsNull())
+	{
+		std::shared_ptr<CloudDataStore> store = m_importJob->ParsedStore();
+		if (store == nullptr)
+			return;
+		m_streamCloud = new AIS_Cloud();
+		m_streamCloud->SetStreamingStore(store);
+		m_streamCloud->SetView(myView);
+		m_lodCtl->RegisterCloud(m_streamCloud);
+		myAisContext->Display(m_streamCloud, Standard_False);
+	}
+
+	std::vector<ColumnTile> tiles;
+	if (m_importJob->TakeStreamedTiles(tiles) == 0)
+		return;
+	m_streamCloud->AppendTiles(std::move(tiles));   // 控制器下次 Tick 自己发现新增的根
+
+	// 预览与叶子重叠显示，到导入结束才撤掉
+	m_lodCtl->Tick();
+	m_lodCtl->UpdateDisplayedStats();
+}
+
+void CMfcOcctView::RemoveStreamingClouds()
+{
+	for (Handle(AIS_Cloud)* c : { &m_previewCloud, &m_streamCloud })
+	{
+		if (c->IsNull())
+			continue;
+		m_lodCtl->UnregisterCloud(*c);
+		myAisContext->Remove(*c, Standard_False);
+		c->Nullify();
+	}
 }
 
 void CMfcOcctView::OnCreateCube()
@@ -566,11 +694,16 @@ void CMfcOcctView::OnCreateCube()
 
 void CMfcOcctView::OnTimer(UINT_PTR nIDEvent)
 {
+	if (nIDEvent == kImportTimerId)
+		PollImport();
+
 	if (m_lod.OnTimer(m_hWnd, nIDEvent)) {
 		// 通过防抖，确认视图期间发生过变化
 		bool anyChanged = false;
 		if (m_lodCtl) {
-			anyChanged = m_lodCtl->Tick();   // 计算 LOD、标记 AIS_Cloud SetToUpdate
+			anyChanged = m_lodCtl->Tick();   // 计算 LOD，就地改各 tile group 画的顶点数
+			if (m_lodCtl->PendingLODs() > 0)
+				m_lod.Mark(m_hWnd);           // 还有 LOD 在后台生成，过一会儿再 Tick 一次
 		}
 
 		if (anyChanged)
@@ -604,6 +737,17 @@ void CMfcOcctView::UpdateHud()
 	txt += (m_lodCtl->UseExperimental() ? "EXPERIMENT" : "BASELINE");
 	txt += "\n";
 
+	txt += "LOD select: ";
+	if (m_lodCtl->Th().screenError)
+	{
+		txt += "screen error <= ";
+		txt += m_lodCtl->Th().maxErrorPx;
+		txt += " px";
+	}
+	else
+		txt += "pixel diagonal";
+	txt += "\n";
+
 	txt += "Cloud points (total): ";
 	txt += (Standard_Integer)hs.globalPoints;
 	txt += "\n";
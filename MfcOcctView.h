@@ -10,6 +10,8 @@
 
 class CloudLodController;
 class SceneHud;
+class CloudImportJob;
+class AIS_Cloud;
 
 class CMfcOcctDoc;
 
@@ -41,6 +43,9 @@ protected: // 仅从序列化创建
 	LodTrigger m_lod;                       // LOD触发器
 	std::unique_ptr<CloudLodController> m_lodCtl;
 	std::unique_ptr<SceneHud> m_sceneHud;
+	std::unique_ptr<CloudImportJob> m_importJob;   // 后台导入，OnTimer 轮询
+	Handle(AIS_Cloud) m_previewCloud;              // 流式导入：解析期间的抽样预览
+	Handle(AIS_Cloud) m_streamCloud;               // 流式导入：陆续加入已完成的叶子
 
 	//! Handle view redraw.
 	virtual void handleViewRedraw(const Handle(AIS_InteractiveContext)&,
@@ -85,6 +90,13 @@ public:
 	void redraw3dView();
 
 	void UpdateHud();
+
+	// 导入进度刷到 HUD；结束后在本线程建 AIS_Cloud 并显示
+	void PollImport();
+	// 流式导入：显示预览、追加已完成的叶子
+	void PollStreaming();
+	// 撤掉流式导入中途显示的对象
+	void RemoveStreamingClouds();
 	// 操作
 public:
 
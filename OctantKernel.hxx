@@ -0,0 +1,292 @@
+// OctantKernel.hxx
+#pragma once
+#include "Column.hxx"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// AVX2 路径在 x64 上总是编译进来，运行时按 CPU 选用（见 OctantKernel::HasAVX2），不要求整个工程 /arch:AVX2
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define OCTANT_AVX2 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define OCTANT_AVX2_FN                                  // MSVC 不加 /arch 也能生成 AVX2 内建函数
+#else
+#define OCTANT_AVX2_FN __attribute__((target("avx2")))
+#endif
+#endif
+
+// 一块点的八分统计：各八分的点数和坐标 min / max（第 4 列是 AVX2 路径整行读写的填充）
+struct OctantStats
+{
+	std::size_t Count[8];
+	double      Min[8][4];
+	double      Max[8][4];
+
+	void Reset()
+	{
+		for (int k = 0; k < 8; ++k)
+		{
+			Count[k] = 0;
+			for (int a = 0; a < 4; ++a)
+			{
+				Min[k][a] = std::numeric_limits<double>::infinity();
+				Max[k][a] = -std::numeric_limits<double>::infinity();
+			}
+		}
+	}
+
+	// 并入另一块（多线程分段统计后合并）
+	void Merge(const OctantStats& o)
+	{
+		for (int k = 0; k < 8; ++k)
+		{
+			Count[k] += o.Count[k];
+			for (int a = 0; a < 3; ++a)
+			{
+				if (o.Min[k][a] < Min[k][a]) Min[k][a] = o.Min[k][a];
+				if (o.Max[k][a] > Max[k][a]) Max[k][a] = o.Max[k][a];
+			}
+		}
+	}
+};
+
+// Position 列上的八分分类 / 包围盒内核：一趟读 SoA 列，按 ids 取点
+// AVX2（x64 且 CPU 支持时运行期选用）：每次 4 点 gather + 比较出八分码，4x4 转置后按八分做向量 min / max；否则标量回退。
+// 两条路径结果逐位相同（float32 存储同样先转 double 再加 Origin，比较 / min / max 对相等值保留先到的）
+// ids 必须都是 pos 的有效存储下标
+struct OctantKernel
+{
+	// codes[i] = ids[i] 的八分码（x >= c[0] 为 1，y 为 2，z 为 4），stats 累加计数与各八分 min / max
+	static void Classify(const Column3f& pos, const int* ids, std::size_t n,
+		const double c[3], uint8_t* codes, OctantStats& stats)
+	{
+#if OCTANT_AVX2
+		if (HasAVX2())
+		{
+			classifyAVX2_(pos, ids, n, c, codes, stats);
+			return;
+		}
+#endif
+		ClassifyScalar(pos, ids, n, c, codes, stats);
+	}
+
+	// ids 各点坐标的 min / max 并入 lo / hi（调用方先置为 +inf / -inf）
+	static void Bounds(const Column3f& pos, const int* ids, std::size_t n, double lo[3], double hi[3])
+	{
+#if OCTANT_AVX2
+		if (HasAVX2())
+		{
+			boundsAVX2_(pos, ids, n, lo, hi);
+			return;
+		}
+#endif
+		BoundsScalar(pos, ids, n, lo, hi);
+	}
+
+	// 运行的 CPU（和操作系统）是否支持 AVX2，只检测一次
+	static bool HasAVX2()
+	{
+#if defined(__AVX2__)
+		return true;   // 整个程序已按 AVX2 编译
+#elif OCTANT_AVX2
+		static const bool has = detectAVX2_();
+		return has;
+#else
+		return false;
+#endif
+	}
+
+	// 标量路径，Classify / Bounds 在不支持 AVX2 时用它，也供基准对照
+	static void ClassifyScalar(const Column3f& pos, const int* ids, std::size_t n,
+		const double c[3], uint8_t* codes, OctantStats& stats)
+	{
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			double x, y, z;
+			pos.Get((std::size_t)ids[i], x, y, z);
+
+			const int oct = (x >= c[0] ? 1 : 0)
+				| (y >= c[1] ? 2 : 0)
+				| (z >= c[2] ? 4 : 0);
+			codes[i] = (uint8_t)oct;
+			++stats.Count[oct];
+			double* lo = stats.Min[oct];
+			double* hi = stats.Max[oct];
+			if (x < lo[0]) lo[0] = x;
+			if (y < lo[1]) lo[1] = y;
+			if (z < lo[2]) lo[2] = z;
+			if (x > hi[0]) hi[0] = x;
+			if (y > hi[1]) hi[1] = y;
+			if (z > hi[2]) hi[2] = z;
+		}
+	}
+
+	static void BoundsScalar(const Column3f& pos, const int* ids, std::size_t n, double lo[3], double hi[3])
+	{
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			double x, y, z;
+			pos.Get((std::size_t)ids[i], x, y, z);
+			if (x < lo[0]) lo[0] = x;
+			if (y < lo[1]) lo[1] = y;
+			if (z < lo[2]) lo[2] = z;
+			if (x > hi[0]) hi[0] = x;
+			if (y > hi[1]) hi[1] = y;
+			if (z > hi[2]) hi[2] = z;
+		}
+	}
+
+private:
+#if OCTANT_AVX2
+	static bool detectAVX2_()
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		int r[4];
+		__cpuid(r, 0);
+		if (r[0] < 7)
+			return false;
+		__cpuid(r, 1);
+		const int osxsaveAvx = (1 << 27) | (1 << 28);
+		if ((r[2] & osxsaveAvx) != osxsaveAvx)
+			return false;
+		if ((_xgetbv(0) & 6) != 6)   // 操作系统保存 YMM 状态
+			return false;
+		__cpuidex(r, 7, 0);
+		return (r[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}
+
+	OCTANT_AVX2_FN static void classifyAVX2_(const Column3f& pos, const int* ids, std::size_t n,
+		const double c[3], uint8_t* codes, OctantStats& stats)
+	{
+		std::size_t i = 0;
+		const __m256d cx = _mm256_set1_pd(c[0]);
+		const __m256d cy = _mm256_set1_pd(c[1]);
+		const __m256d cz = _mm256_set1_pd(c[2]);
+		__m256d mn[8], mx[8];
+		for (int k = 0; k < 8; ++k)
+		{
+			mn[k] = _mm256_loadu_pd(stats.Min[k]);
+			mx[k] = _mm256_loadu_pd(stats.Max[k]);
+		}
+
+		for (; i + 4 <= n; i += 4)
+		{
+			__m256d x, y, z;
+			gather4_(pos, ids + i, x, y, z);
+
+			const uint32_t code4 = spread4_(_mm256_movemask_pd(_mm256_cmp_pd(x, cx, _CMP_GE_OQ)))
+				| (spread4_(_mm256_movemask_pd(_mm256_cmp_pd(y, cy, _CMP_GE_OQ))) << 1)
+				| (spread4_(_mm256_movemask_pd(_mm256_cmp_pd(z, cz, _CMP_GE_OQ))) << 2);
+			std::memcpy(codes + i, &code4, 4);
+
+			// 转置成每点一个 (x, y, z, z) 向量，再并进所属八分
+			const __m256d t0 = _mm256_unpacklo_pd(x, y);
+			const __m256d t1 = _mm256_unpackhi_pd(x, y);
+			const __m256d t2 = _mm256_unpacklo_pd(z, z);
+			const __m256d t3 = _mm256_unpackhi_pd(z, z);
+			const __m256d p[4] = {
+				_mm256_permute2f128_pd(t0, t2, 0x20),
+				_mm256_permute2f128_pd(t1, t3, 0x20),
+				_mm256_permute2f128_pd(t0, t2, 0x31),
+				_mm256_permute2f128_pd(t1, t3, 0x31) };
+			for (int j = 0; j < 4; ++j)
+			{
+				const int oct = codes[i + j];
+				++stats.Count[oct];
+				mn[oct] = _mm256_min_pd(p[j], mn[oct]);
+				mx[oct] = _mm256_max_pd(p[j], mx[oct]);
+			}
+		}
+
+		for (int k = 0; k < 8; ++k)
+		{
+			_mm256_storeu_pd(stats.Min[k], mn[k]);
+			_mm256_storeu_pd(stats.Max[k], mx[k]);
+		}
+		ClassifyScalar(pos, ids + i, n - i, c, codes + i, stats);
+	}
+
+	OCTANT_AVX2_FN static void boundsAVX2_(const Column3f& pos, const int* ids, std::size_t n, double lo[3], double hi[3])
+	{
+		std::size_t i = 0;
+		if (n >= 4)
+		{
+			__m256d lx = _mm256_set1_pd(lo[0]), ly = _mm256_set1_pd(lo[1]), lz = _mm256_set1_pd(lo[2]);
+			__m256d hx = _mm256_set1_pd(hi[0]), hy = _mm256_set1_pd(hi[1]), hz = _mm256_set1_pd(hi[2]);
+			for (; i + 4 <= n; i += 4)
+			{
+				__m256d x, y, z;
+				gather4_(pos, ids + i, x, y, z);
+				lx = _mm256_min_pd(x, lx); ly = _mm256_min_pd(y, ly); lz = _mm256_min_pd(z, lz);
+				hx = _mm256_max_pd(x, hx); hy = _mm256_max_pd(y, hy); hz = _mm256_max_pd(z, hz);
+			}
+			// 横向归约：min / max 与顺序无关（只在 ±0 上可能取到另一个零，包围盒上等价）
+			double l[3][4], h[3][4];
+			_mm256_storeu_pd(l[0], lx); _mm256_storeu_pd(l[1], ly); _mm256_storeu_pd(l[2], lz);
+			_mm256_storeu_pd(h[0], hx); _mm256_storeu_pd(h[1], hy); _mm256_storeu_pd(h[2], hz);
+			for (int a = 0; a < 3; ++a)
+			{
+				for (int j = 0; j < 4; ++j)
+				{
+					if (l[a][j] < lo[a]) lo[a] = l[a][j];
+					if (h[a][j] > hi[a]) hi[a] = h[a][j];
+				}
+			}
+		}
+		BoundsScalar(pos, ids + i, n - i, lo, hi);
+	}
+
+	// 取 ids[0..3] 的坐标；float32 存储转 double 后加 Origin，与 Column3f::Get 相同
+	// 4 个下标连续（根节点、重排过点序的点云大多如此）时直接顺序读，不走 gather
+	OCTANT_AVX2_FN static void gather4_(const Column3f& pos, const int* ids, __m256d& x, __m256d& y, __m256d& z)
+	{
+		const __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids));
+		const __m128i run = _mm_add_epi32(_mm_set1_epi32(ids[0]), _mm_setr_epi32(0, 1, 2, 3));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(vi, run)) == 0xFFFF)
+		{
+			const std::size_t g = (std::size_t)ids[0];
+			if (pos.X)
+			{
+				x = _mm256_loadu_pd(pos.X + g);
+				y = _mm256_loadu_pd(pos.Y + g);
+				z = _mm256_loadu_pd(pos.Z + g);
+			}
+			else
+			{
+				x = _mm256_add_pd(_mm256_set1_pd(pos.Origin[0]), _mm256_cvtps_pd(_mm_loadu_ps(pos.FX + g)));
+				y = _mm256_add_pd(_mm256_set1_pd(pos.Origin[1]), _mm256_cvtps_pd(_mm_loadu_ps(pos.FY + g)));
+				z = _mm256_add_pd(_mm256_set1_pd(pos.Origin[2]), _mm256_cvtps_pd(_mm_loadu_ps(pos.FZ + g)));
+			}
+		}
+		else if (pos.X)
+		{
+			x = _mm256_i32gather_pd(pos.X, vi, 8);
+			y = _mm256_i32gather_pd(pos.Y, vi, 8);
+			z = _mm256_i32gather_pd(pos.Z, vi, 8);
+		}
+		else
+		{
+			x = _mm256_add_pd(_mm256_set1_pd(pos.Origin[0]), _mm256_cvtps_pd(_mm_i32gather_ps(pos.FX, vi, 4)));
+			y = _mm256_add_pd(_mm256_set1_pd(pos.Origin[1]), _mm256_cvtps_pd(_mm_i32gather_ps(pos.FY, vi, 4)));
+			z = _mm256_add_pd(_mm256_set1_pd(pos.Origin[2]), _mm256_cvtps_pd(_mm_i32gather_ps(pos.FZ, vi, 4)));
+		}
+	}
+
+	// 4 位比较掩码 -> 4 个字节各放一位（小端：第 j 字节 = 第 j 点）
+	static uint32_t spread4_(int m)
+	{
+		static const uint32_t kSpread[16] = {
+			0x00000000u, 0x00000001u, 0x00000100u, 0x00000101u,
+			0x00010000u, 0x00010001u, 0x00010100u, 0x00010101u,
+			0x01000000u, 0x01000001u, 0x01000100u, 0x01000101u,
+			0x01010000u, 0x01010001u, 0x01010100u, 0x01010101u };
+		return kSpread[m & 15];
+	}
+#endif
+};
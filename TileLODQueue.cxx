@@ -0,0 +1,114 @@
+// TileLODQueue.cxx
+#include "TileLODQueue.hxx"
+#include "ColumnTileLOD.hxx"
+#include <algorithm>
+
+TileLODQueue::TileLODQueue(int threads)
+{
+	if (threads <= 0)
+		threads = (int)std::max(2u, std::thread::hardware_concurrency()) - 1;
+	for (int t = 0; t < threads; ++t)
+		workers_.emplace_back(&TileLODQueue::run_, this);
+}
+
+TileLODQueue::~TileLODQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+		jobs_.clear();
+	}
+	wake_.notify_all();
+	for (std::thread& w : workers_)
+		w.join();
+}
+
+void TileLODQueue::Reset(const std::shared_ptr<CloudDataStore>& store, const CloudColumns& columns)
+{
+	auto src = std::make_shared<Source>();
+	src->Store = store;
+	src->Columns = columns;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	++generation_;
+	jobs_.clear();
+	done_.clear();
+	pending_.clear();
+	source_ = std::move(src);
+}
+
+bool TileLODQueue::Request(int tileIndex, const ColumnTile& tile)
+{
+	if (tile.LODs.empty() || (int)tile.LODs.size() >= tile.LODsPlanned)
+		return false;
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (!source_ || pending_.count(tileIndex))
+		return false;
+	pending_.insert(tileIndex);
+	lock.unlock();
+
+	// 副本只带补齐要用的字段：划分信息 + LOD0（量化 tile 连同量化块），不碰 GArray
+	Job job;
+	job.Tile = tileIndex;
+	job.Work.Depth = tile.Depth;
+	job.Work.BBox = tile.BBox;
+	job.Work.Children = tile.Children;
+	job.Work.Indices = tile.Indices;
+	job.Work.OrderOffset = tile.OrderOffset;
+	job.Work.OrderCount = tile.OrderCount;
+	job.Work.RangeIndices = tile.RangeIndices;
+	job.Work.Quant = tile.Quant;
+	job.Work.LODs.assign(tile.LODs.begin(), tile.LODs.begin() + 1);
+	job.Work.LODsPlanned = tile.LODsPlanned;
+
+	lock.lock();
+	job.Generation = generation_;
+	job.Src = source_;
+	jobs_.push_back(std::move(job));
+	lock.unlock();
+	wake_.notify_one();
+	return true;
+}
+
+std::size_t TileLODQueue::Take(std::vector<Result>& out)
+{
+	out.clear();
+	std::lock_guard<std::mutex> lock(mutex_);
+	out.swap(done_);
+	for (const Result& r : out)
+		pending_.erase(r.Tile);
+	return out.size();
+}
+
+std::size_t TileLODQueue::Pending() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return pending_.size();
+}
+
+void TileLODQueue::run_()
+{
+	for (;;)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			wake_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+			if (stop_)
+				return;
+			job = std::move(jobs_.front());
+			jobs_.pop_front();
+		}
+
+		CompleteTileLODs(job.Src->Columns, job.Work);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (job.Generation != generation_)
+			continue;   // 数据源已换，结果作废
+		Result r;
+		r.Tile = job.Tile;
+		r.Work = std::move(job.Work);
+		done_.push_back(std::move(r));
+	}
+}
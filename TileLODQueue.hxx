@@ -0,0 +1,74 @@
+// TileLODQueue.hxx
+#pragma once
+#include "CloudDataStore.hxx"
+#include "CloudColumns.hxx"
+#include "ColumnTile.hxx"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// 懒生成 LOD 的后台队列（CloudTileSetup::LazyLODs）
+//
+// UI 线程 Request 某个 tile 时拷一份只带 LOD0 的副本，工作线程用 CompleteTileLODs 补齐各级；
+// 这期间 tile 照旧画当前的级别，UI 线程 Take 到结果后再原地换入（见 AIS_Cloud::PublishTileLODs）。
+// 工作线程只读 store 的列，队列持有 store 直到任务做完；Reset 换数据源后旧任务的结果直接丢弃。
+// 量化过的 tile 副本带着自己的量化块，补齐时不读 store（此时 store 的坐标列已释放）。
+class TileLODQueue
+{
+public:
+	struct Result
+	{
+		int        Tile = -1;   // 请求时的 tile 下标
+		ColumnTile Work;        // 补齐后的副本：LODs / Indices（叶子的嵌套点序）/ Quant（按新点序重排的量化块）
+	};
+
+	explicit TileLODQueue(int threads = 0);   // 0 = 硬件线程数 - 1（至少 1）
+	~TileLODQueue();                          // 丢掉未开始的任务，等待工作线程退出
+
+	TileLODQueue(const TileLODQueue&) = delete;
+	TileLODQueue& operator=(const TileLODQueue&) = delete;
+
+	// 换数据源（tile 集被整体替换时）：未开始的任务和未取走的结果丢弃，进行中的做完后丢弃
+	void Reset(const std::shared_ptr<CloudDataStore>& store, const CloudColumns& columns);
+
+	// 请求补齐 tile 的 LOD；已在排队、进行中或做完未取的返回 false
+	bool Request(int tileIndex, const ColumnTile& tile);
+
+	// 取走已做完的结果，返回个数
+	std::size_t Take(std::vector<Result>& out);
+
+	// 已请求、结果还没被取走的 tile 数
+	std::size_t Pending() const;
+
+private:
+	struct Source
+	{
+		std::shared_ptr<CloudDataStore> Store;
+		CloudColumns                    Columns;
+	};
+
+	struct Job
+	{
+		int                           Tile = -1;
+		unsigned                      Generation = 0;
+		std::shared_ptr<const Source> Src;
+		ColumnTile                    Work;
+	};
+
+	void run_();
+
+private:
+	mutable std::mutex            mutex_;
+	std::condition_variable       wake_;
+	std::deque<Job>               jobs_;
+	std::vector<Result>           done_;
+	std::unordered_set<int>       pending_;      // 排队 / 进行中 / 做完未取
+	std::shared_ptr<const Source> source_;
+	unsigned                      generation_ = 0;
+	bool                          stop_ = false;
+	std::vector<std::thread>      workers_;
+};
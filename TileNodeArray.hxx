@@ -0,0 +1,166 @@
+// TileNodeArray.hxx
+#pragma once
+#include "..\ColumnTile.hxx"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// LOD 选取用的紧凑节点数组：tile 层级的热数据按 DFS 先序摊平成 SoA
+//
+// 节点 k 的子树是 [k, End[k])，有子节点时第一个子节点就是 k + 1，
+// 遍历不用栈：下探走 k + 1，剪掉子树走 End[k]。
+// 冷数据（ColumnTile 的 Bnd_Box / 索引 / GArray）只在真正显示、隐藏时才碰。
+struct TileNodeArray
+{
+	static constexpr uint8_t kHidden = 0xFF;
+
+	std::vector<float>    Box;          // 每节点 6 个：xmin ymin zmin xmax ymax zmax，相对 Origin；空盒 xmin > xmax
+	std::vector<int32_t>  Tile;         // 对应 cloud->Tiles() 的下标
+	std::vector<int32_t>  End;          // 子树末尾（下一个非后代节点）
+	std::vector<uint16_t> ChildCount;   // 0 = 叶子
+	std::vector<uint32_t> LodFirst;     // 节点 k 的各级点数是 LodPoints[LodFirst[k], LodFirst[k + 1])
+	std::vector<int32_t>  LodPoints;    // 懒生成还没建的级别按 LOD0 / 2^k 估计（见 ColumnTile::LODsPlanned）
+	std::vector<float>    LodError;     // 与 LodPoints 对齐：各级 ErrorWorld；没建的级别按 LOD0 * sqrt(2)^k 估计
+	std::vector<uint8_t>  Ready;        // 已建好的级数，[Ready[k], NumLODs(k)) 待后台补齐
+	std::vector<uint8_t>  Current;      // 当前显示的 LOD，kHidden = 未显示
+	std::vector<int32_t>  NodeOfTile;   // tile 下标 -> 节点下标（换入补齐的 LOD 时用），-1 = 不在数组里
+
+	// 包围盒的 double 原点（第一个非空盒的最小角），同 Float32 列的做法：
+	// UTM 坐标（北向 4~9e6）直接存 float 只剩 0.5 的分辨率，相对原点存才保得住 tile 的尺寸
+	double Origin[3] = { 0.0, 0.0, 0.0 };
+	bool   HasOrigin = false;
+
+	std::size_t Size() const { return Tile.size(); }
+	int NumLODs(std::size_t k) const { return (int)(LodFirst[k + 1] - LodFirst[k]); }
+	const int32_t* LodCost(std::size_t k) const { return LodPoints.data() + LodFirst[k]; }
+	const float* LodErr(std::size_t k) const { return LodError.data() + LodFirst[k]; }
+
+	// 节点包围盒的世界对角线长度，空盒为 0（相对原点的差值，不受坐标量级影响）
+	double Diagonal(std::size_t k) const
+	{
+		const float* b = &Box[k * 6];
+		if (b[0] > b[3])
+			return 0.0;
+		const double dx = b[3] - b[0], dy = b[4] - b[1], dz = b[5] - b[2];
+		return std::sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	void Clear()
+	{
+		Box.clear(); Tile.clear(); End.clear(); ChildCount.clear();
+		Origin[0] = Origin[1] = Origin[2] = 0.0; HasOrigin = false;
+		LodFirst.assign(1, 0u); LodPoints.clear(); LodError.clear(); Ready.clear(); Current.clear(); NodeOfTile.clear();
+	}
+
+	// tile 的 LOD 补齐后刷新节点 k 的各级点数（级数不变）
+	void UpdateLODs(std::size_t k, const ColumnTile& tile)
+	{
+		const int n = std::min(NumLODs(k), (int)tile.LODs.size());
+		for (int i = 0; i < n; ++i)
+		{
+			LodPoints[LodFirst[k] + i] = (int32_t)tile.LODs[i].PointCount;
+			LodError[LodFirst[k] + i] = (float)tile.LODs[i].ErrorWorld;
+		}
+		Ready[k] = (uint8_t)n;
+	}
+
+	// 把 tiles[from, end) 中的根及其子树按 DFS 先序追加进来（流式追加的 tile 只会是新的根）
+	void AppendRoots(const std::vector<ColumnTile>& tiles, std::size_t from)
+	{
+		if (LodFirst.empty())
+			LodFirst.push_back(0u);
+
+		const std::size_t base = Tile.size();
+		NodeOfTile.resize(tiles.size(), -1);
+		std::vector<int> stack;                // 待访问的 tile 下标，根倒序压栈以便按原顺序弹出
+		for (std::size_t r = tiles.size(); r-- > from; )
+		{
+			if (tiles[r].Parent < 0)
+				stack.push_back((int)r);
+		}
+
+		std::vector<int32_t> parentOfStack(stack.size(), -1);   // 与 stack 对齐：父节点在本数组里的下标
+		std::vector<int32_t> parent;                            // 新节点的父节点，根为 -1
+		while (!stack.empty())
+		{
+			const int t = stack.back();
+			const int32_t p = parentOfStack.back();
+			stack.pop_back();
+			parentOfStack.pop_back();
+
+			const ColumnTile& tile = tiles[t];
+			const int32_t k = (int32_t)Tile.size();
+			push_(tile, t);
+			parent.push_back(p);
+
+			int children = 0;
+			for (auto it = tile.Children.rbegin(); it != tile.Children.rend(); ++it)
+			{
+				if (*it < 0 || *it >= (int)tiles.size())
+					continue;
+				stack.push_back(*it);
+				parentOfStack.push_back(k);
+				++children;
+			}
+			ChildCount.back() = (uint16_t)children;
+		}
+
+		// 倒序把子树末尾传给父节点
+		for (std::size_t k = Tile.size(); k-- > base; )
+		{
+			const int32_t p = parent[k - base];
+			if (p >= 0 && End[p] < End[k])
+				End[p] = End[k];
+		}
+	}
+
+private:
+	void push_(const ColumnTile& tile, int t)
+	{
+		Standard_Real b[6] = { 1.0, 1.0, 1.0, 0.0, 0.0, 0.0 };
+		if (!tile.BBox.IsVoid())
+		{
+			tile.BBox.Get(b[0], b[1], b[2], b[3], b[4], b[5]);
+			if (!HasOrigin)
+			{
+				Origin[0] = b[0]; Origin[1] = b[1]; Origin[2] = b[2];
+				HasOrigin = true;
+			}
+			// 转 float 时最小角向下、最大角向上取整，盒子只会略大不会变小
+			for (int i = 0; i < 6; ++i)
+			{
+				const double rel = b[i] - Origin[i % 3];
+				float f = (float)rel;
+				if (i < 3 ? f > rel : f < rel)
+					f = std::nextafter(f, i < 3 ? -HUGE_VALF : HUGE_VALF);
+				Box.push_back(f);
+			}
+		}
+		else
+		{
+			for (int i = 0; i < 6; ++i)
+				Box.push_back((float)b[i]);
+		}
+
+		NodeOfTile[t] = (int32_t)Tile.size();
+		Tile.push_back(t);
+		End.push_back((int32_t)Tile.size());
+		ChildCount.push_back(0);
+		for (const TileLODLevel& lvl : tile.LODs)
+		{
+			LodPoints.push_back((int32_t)lvl.PointCount);
+			LodError.push_back((float)lvl.ErrorWorld);
+		}
+		const std::size_t full = tile.LODs.empty() ? 0 : tile.LODs.front().PointCount;
+		const double err0 = tile.LODs.empty() ? 0.0 : tile.LODs.front().ErrorWorld;
+		for (int k = (int)tile.LODs.size(); k < tile.LODsPlanned; ++k)
+		{
+			LodPoints.push_back((int32_t)((full + ((std::size_t)1 << k) - 1) >> k));
+			LodError.push_back((float)(err0 * std::pow(2.0, 0.5 * k)));   // 面状点云：点数减半，间距约乘 sqrt(2)
+		}
+		LodFirst.push_back((uint32_t)LodPoints.size());
+		Ready.push_back((uint8_t)tile.LODs.size());
+		Current.push_back(kHidden);
+	}
+};
@@ -0,0 +1,197 @@
+// TileQuant.hxx
+#pragma once
+#include "Column.hxx"
+#include <Bnd_Box.hxx>
+#include <Standard_Real.hxx>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TILEQUANT_SSE2 1
+#endif
+
+// tile 内 16 位量化编码（CloudTileSetup::Quantize）
+//
+// 坐标：按 tile BBox 每轴量化成 uint16，世界坐标 = Origin + q * Step；
+// 法向：每分量 snorm8，仅用于着色。按 tile 的 LOD0 点序存放，嵌套的第 k 级就是前 LODs[k].PointCount 个点。
+// 每点 6 + 3 字节。量化之后 tile 不再引用全局下标，store 的坐标 / 法向列随即释放（CloudDataStore::ReleaseCoordinates），
+// GPU 数组和懒生成的 LOD 都从块里来：double 存储每点省下 48 字节坐标 / 法向和 4 ~ 8 字节索引，float 存储 24 字节
+struct TileQuantBlock
+{
+	Standard_Real Origin[3] = { 0.0, 0.0, 0.0 };   // BBox 最小角
+	Standard_Real Step[3] = { 0.0, 0.0, 0.0 };     // 每级量化的世界长度 = 边长 / 65535
+
+	std::vector<uint16_t> QX, QY, QZ;
+	std::vector<int8_t>   QNX, QNY, QNZ;          // 无法向时为空
+
+	bool        Empty()      const { return QX.empty(); }
+	std::size_t Size()       const { return QX.size(); }
+	bool        HasNormals() const { return !QNX.empty(); }
+
+	// 最大位置误差：取最近格点，每轴最多半个 Step
+	Standard_Real MaxError() const
+	{
+		return 0.5 * std::sqrt(Step[0] * Step[0] + Step[1] * Step[1] + Step[2] * Step[2]);
+	}
+
+	std::size_t Bytes() const
+	{
+		return QX.size() * 3 * sizeof(uint16_t) + QNX.size() * 3 * sizeof(int8_t);
+	}
+
+	void Clear() { *this = TileQuantBlock(); }
+
+	// 按 order 重排：新的第 i 个点 = 原第 order[i] 个点（order 是 0..Size()-1 的排列）
+	void Permute(const std::vector<int>& order)
+	{
+		auto apply = [&order](auto& v) {
+			if (v.empty()) return;
+			std::remove_reference_t<decltype(v)> out(v.size());
+			for (std::size_t i = 0; i < order.size(); ++i)
+				out[i] = v[(std::size_t)order[i]];
+			v.swap(out);
+		};
+		apply(QX); apply(QY); apply(QZ);
+		apply(QNX); apply(QNY); apply(QNZ);
+	}
+};
+
+// 把 indices 指向的点按给定顺序编码进 out；box 为空时按点自身范围
+inline void EncodeTileQuant(const Column3f& pos, const Column3f& nrm,
+	const std::vector<int>& indices, const Bnd_Box& box, TileQuantBlock& out)
+{
+	out.Clear();
+	if (!pos.IsValid() || indices.empty())
+		return;
+
+	Standard_Real mn[3], mx[3];
+	if (!box.IsVoid())
+	{
+		box.Get(mn[0], mn[1], mn[2], mx[0], mx[1], mx[2]);
+	}
+	else
+	{
+		pos.Get(indices[0], mn[0], mn[1], mn[2]);
+		std::copy(mn, mn + 3, mx);
+		for (int id : indices)
+		{
+			Standard_Real p[3];
+			pos.Get(id, p[0], p[1], p[2]);
+			for (int k = 0; k < 3; ++k) { mn[k] = std::min(mn[k], p[k]); mx[k] = std::max(mx[k], p[k]); }
+		}
+	}
+
+	Standard_Real inv[3];
+	for (int k = 0; k < 3; ++k)
+	{
+		out.Origin[k] = mn[k];
+		out.Step[k] = (mx[k] - mn[k]) / 65535.0;
+		inv[k] = out.Step[k] > 0.0 ? 1.0 / out.Step[k] : 0.0;
+	}
+
+	auto q16 = [](Standard_Real v) -> uint16_t {
+		const Standard_Real r = std::floor(v + 0.5);
+		return (uint16_t)(r < 0.0 ? 0.0 : (r > 65535.0 ? 65535.0 : r));
+	};
+	auto q8 = [](Standard_Real v) -> int8_t {
+		const Standard_Real r = std::floor(v * 127.0 + 0.5);
+		return (int8_t)(r < -127.0 ? -127.0 : (r > 127.0 ? 127.0 : r));
+	};
+
+	const std::size_t n = indices.size();
+	const bool withN = nrm.IsValid();
+	out.QX.resize(n); out.QY.resize(n); out.QZ.resize(n);
+	if (withN) { out.QNX.resize(n); out.QNY.resize(n); out.QNZ.resize(n); }
+
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		Standard_Real x, y, z;
+		pos.Get(indices[i], x, y, z);
+		out.QX[i] = q16((x - mn[0]) * inv[0]);
+		out.QY[i] = q16((y - mn[1]) * inv[1]);
+		out.QZ[i] = q16((z - mn[2]) * inv[2]);
+		if (withN)
+		{
+			nrm.Get(indices[i], x, y, z);
+			out.QNX[i] = q8(x); out.QNY[i] = q8(y); out.QNZ[i] = q8(z);
+		}
+	}
+}
+
+// 一个轴的前 count 个点：out[i] = (float)(origin + q[i] * step)
+// SSE2：每次 8 个，double 计算后转 float，与标量尾部逐位一致
+inline void DecodeTileQuantAxis(const uint16_t* q, std::size_t count, double origin, double step, float* out)
+{
+	std::size_t i = 0;
+#if TILEQUANT_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128d o = _mm_set1_pd(origin);
+	const __m128d st = _mm_set1_pd(step);
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + i));
+		const __m128i lo = _mm_unpacklo_epi16(v, zero);   // 4 x int32
+		const __m128i hi = _mm_unpackhi_epi16(v, zero);
+
+		const __m128d d0 = _mm_add_pd(o, _mm_mul_pd(_mm_cvtepi32_pd(lo), st));
+		const __m128d d1 = _mm_add_pd(o, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(lo, 8)), st));
+		const __m128d d2 = _mm_add_pd(o, _mm_mul_pd(_mm_cvtepi32_pd(hi), st));
+		const __m128d d3 = _mm_add_pd(o, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(hi, 8)), st));
+
+		_mm_storeu_ps(out + i, _mm_movelh_ps(_mm_cvtpd_ps(d0), _mm_cvtpd_ps(d1)));
+		_mm_storeu_ps(out + i + 4, _mm_movelh_ps(_mm_cvtpd_ps(d2), _mm_cvtpd_ps(d3)));
+	}
+#endif
+	for (; i < count; ++i)
+		out[i] = (float)(origin + (double)q[i] * step);
+}
+
+// 解码前 count 个点到 float SoA（渲染格式，世界坐标）；outN* 可为空，块无法向时输出 (0,0,1)
+inline void DecodeTileQuant(const TileQuantBlock& q, std::size_t count,
+	float* outX, float* outY, float* outZ,
+	float* outNX = nullptr, float* outNY = nullptr, float* outNZ = nullptr)
+{
+	count = std::min(count, q.Size());
+	DecodeTileQuantAxis(q.QX.data(), count, q.Origin[0], q.Step[0], outX);
+	DecodeTileQuantAxis(q.QY.data(), count, q.Origin[1], q.Step[1], outY);
+	DecodeTileQuantAxis(q.QZ.data(), count, q.Origin[2], q.Step[2], outZ);
+
+	if (!outNX)
+		return;
+	if (!q.HasNormals())
+	{
+		std::fill(outNX, outNX + count, 0.0f);
+		std::fill(outNY, outNY + count, 0.0f);
+		std::fill(outNZ, outNZ + count, 1.0f);
+		return;
+	}
+	// 法向只有 3 字节，标量换算即可（连续读写，编译器会自动向量化）
+	const float k = 1.0f / 127.0f;
+	for (std::size_t j = 0; j < count; ++j)
+	{
+		outNX[j] = q.QNX[j] * k;
+		outNY[j] = q.QNY[j] * k;
+		outNZ[j] = q.QNZ[j] * k;
+	}
+}
+
+// 全部点解码成块内局部坐标（q * Step，float），绑定到 pos：pos.Origin = 块的 Origin，稠密下标 0..Size()-1
+// 懒生成 LOD 在块上采样用（见 CompleteTileLODs），坐标相对 tile 角点，float 的舍入远小于量化步长
+inline void DecodeTileQuantLocal(const TileQuantBlock& q,
+	std::vector<float>& x, std::vector<float>& y, std::vector<float>& z, Column3f& pos)
+{
+	const std::size_t n = q.Size();
+	x.resize(n); y.resize(n); z.resize(n);
+	DecodeTileQuantAxis(q.QX.data(), n, 0.0, q.Step[0], x.data());
+	DecodeTileQuantAxis(q.QY.data(), n, 0.0, q.Step[1], y.data());
+	DecodeTileQuantAxis(q.QZ.data(), n, 0.0, q.Step[2], z.data());
+
+	pos = Column3f();
+	pos.FX = x.data(); pos.FY = y.data(); pos.FZ = z.data();
+	pos.Origin[0] = q.Origin[0]; pos.Origin[1] = q.Origin[1]; pos.Origin[2] = q.Origin[2];
+	pos.Count = n;
+}
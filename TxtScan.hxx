@@ -0,0 +1,159 @@
+// TxtScan.hxx
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TXTSCAN_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TXTSCAN_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// 文本点云的字节扫描内核：行尾 / 分隔符查找、换行计数
+// AVX2（编译期 /arch:AVX2）> SSE2（x64 默认）> 标量回退，三条路径结果完全一致
+struct TxtScan
+{
+	// 第一个 '\n' 或 '\r'，找不到返回 end
+	static const char* FindEOL(const char* p, const char* end)
+	{
+#if TXTSCAN_AVX2
+		const __m256i nl32 = _mm256_set1_epi8('\n');
+		const __m256i cr32 = _mm256_set1_epi8('\r');
+		while (end - p >= 32)
+		{
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			const uint32_t m = (uint32_t)_mm256_movemask_epi8(
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, nl32), _mm256_cmpeq_epi8(v, cr32)));
+			if (m) return p + ctz32(m);
+			p += 32;
+		}
+#endif
+#if TXTSCAN_SSE2
+		const __m128i nl = _mm_set1_epi8('\n');
+		const __m128i cr = _mm_set1_epi8('\r');
+		while (end - p >= 16)
+		{
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const uint32_t m = (uint32_t)_mm_movemask_epi8(
+				_mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, cr)));
+			if (m) return p + ctz32(m);
+			p += 16;
+		}
+#endif
+		while (p < end && *p != '\n' && *p != '\r') ++p;
+		return p;
+	}
+
+	// 字段结束：第一个 ' ' '\t' '\r' '\n'，找不到返回 end
+	static const char* FindDelim(const char* p, const char* end)
+	{
+#if TXTSCAN_SSE2
+		// 字段通常不到 16 字节，只用 128 位一档
+		const __m128i sp = _mm_set1_epi8(' ');
+		const __m128i tb = _mm_set1_epi8('\t');
+		const __m128i nl = _mm_set1_epi8('\n');
+		const __m128i cr = _mm_set1_epi8('\r');
+		while (end - p >= 16)
+		{
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i d = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, tb)),
+				_mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, cr)));
+			const uint32_t m = (uint32_t)_mm_movemask_epi8(d);
+			if (m) return p + ctz32(m);
+			p += 16;
+		}
+#endif
+		while (p < end && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') ++p;
+		return p;
+	}
+
+	// 跳过字段间的 ' ' / '\t'（通常只有 1~2 个字节，标量即可）
+	static const char* SkipBlanks(const char* p, const char* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t')) ++p;
+		return p;
+	}
+
+	// 统计 [p, end) 内 '\n' 的个数
+	static std::size_t CountNewlines(const char* p, const char* end)
+	{
+		std::size_t count = 0;
+#if TXTSCAN_AVX2
+		{
+			const __m256i nl = _mm256_set1_epi8('\n');
+			const __m256i zero = _mm256_setzero_si256();
+			while (end - p >= 32)
+			{
+				// 字节计数器最多累加 255 次后用 SAD 横向求和
+				std::size_t blocks = std::min<std::size_t>((std::size_t)(end - p) / 32, 255);
+				__m256i acc = zero;
+				for (; blocks > 0; --blocks, p += 32)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+					acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(v, nl));
+				}
+				// 4 个 64 位和各不超过 8 * 255，折成两个后仍在 16 位内，按 SSE2 路径取低字；
+				// 不用 _mm256_extract_epi64，它只有 x64 才有，32 位 /arch:AVX2 编不过
+				const __m256i s = _mm256_sad_epu8(acc, zero);
+				const __m128i h = _mm_add_epi64(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+				count += (std::size_t)_mm_cvtsi128_si32(h) + (std::size_t)_mm_extract_epi16(h, 4);
+			}
+		}
+#endif
+#if TXTSCAN_SSE2
+		{
+			const __m128i nl = _mm_set1_epi8('\n');
+			const __m128i zero = _mm_setzero_si128();
+			while (end - p >= 16)
+			{
+				std::size_t blocks = std::min<std::size_t>((std::size_t)(end - p) / 16, 255);
+				__m128i acc = zero;
+				for (; blocks > 0; --blocks, p += 16)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+					acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(v, nl));
+				}
+				const __m128i s = _mm_sad_epu8(acc, zero);
+				count += (std::size_t)_mm_cvtsi128_si32(s) + (std::size_t)_mm_extract_epi16(s, 4);
+			}
+		}
+#endif
+		for (; p < end; ++p) if (*p == '\n') ++count;
+		return count;
+	}
+
+	// 用开头一小段采样平均行长，估计 [beg, end) 的行数（供 reserve，不再整文件预扫）
+	// 估偏时 vector 按几何增长兜底
+	static std::size_t EstimateLines(const char* beg, const char* end,
+		std::size_t sampleBytes = std::size_t(256) << 10)
+	{
+		const std::size_t total = (std::size_t)(end - beg);
+		if (total == 0) return 0;
+		const std::size_t sample = std::min(total, sampleBytes);
+		const std::size_t nl = CountNewlines(beg, beg + sample);
+		if (sample == total) return nl + 1;
+		if (nl == 0) return total / sample + 1;
+		const double bytesPerLine = double(sample) / double(nl);
+		return (std::size_t)(double(total) / bytesPerLine * 1.02) + 16;
+	}
+
+private:
+	static unsigned ctz32(uint32_t m)
+	{
+#if defined(_MSC_VER)
+		unsigned long i;
+		_BitScanForward(&i, m);
+		return (unsigned)i;
+#else
+		return (unsigned)__builtin_ctz(m);
+#endif
+	}
+};
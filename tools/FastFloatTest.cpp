@@ -0,0 +1,128 @@
+// FastFloatTest.cpp
+// FastFloat::Parse 与 std::from_chars 的随机逐位一致性测试
+//
+// 独立程序，不在 MfcOcct.vcxproj 里。编译（在仓库根目录）：
+//   cl /O2 /std:c++17 /EHsc tools\FastFloatTest.cpp
+//   g++ -O2 -std=c++17 tools/FastFloatTest.cpp -o FastFloatTest
+// 用法：FastFloatTest [样本数=20000000] [种子=1]
+// 比较 errc、结束指针，成功时再比较结果的全部 64 位；有不一致时打印前若干条并返回 1
+#include "../FastFloat.hxx"
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace {
+	std::mt19937_64 g_rng;
+
+	int randInt(int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(g_rng); }
+
+	void appendDigits(std::string& s, int n)
+	{
+		for (int i = 0; i < n; ++i) s.push_back(char('0' + randInt(0, 9)));
+	}
+
+	// 点云文本里常见的定点小数：[-]整数[.小数]，含前导零、超长尾数（>19 位走回退）
+	std::string genFixed()
+	{
+		std::string s;
+		if (randInt(0, 3) == 0) s.push_back('-');
+		else if (randInt(0, 15) == 0) s.push_back('+');
+		appendDigits(s, randInt(0, 12));
+		if (randInt(0, 7) != 0)
+		{
+			s.push_back('.');
+			appendDigits(s, randInt(0, randInt(0, 4) == 0 ? 24 : 10));
+		}
+		if (randInt(0, 7) == 0)
+		{
+			s.push_back(randInt(0, 1) ? 'e' : 'E');
+			if (randInt(0, 1)) s.push_back(randInt(0, 1) ? '-' : '+');
+			appendDigits(s, randInt(0, 3));
+		}
+		return s;
+	}
+
+	// 任意位模式的 double 按 %.17g / %.6f / %a 输出（覆盖次正规数、大指数、inf/nan 文本）
+	std::string genPrinted()
+	{
+		std::uint64_t bits = g_rng();
+		double d;
+		std::memcpy(&d, &bits, sizeof d);
+		if (randInt(0, 1)) d = (double)(std::int64_t)(g_rng() >> randInt(11, 63)) / std::pow(10.0, randInt(0, 9));
+		char buf[512];
+		switch (randInt(0, 2))
+		{
+		case 0:  std::snprintf(buf, sizeof buf, "%.17g", d); break;
+		case 1:  std::snprintf(buf, sizeof buf, "%.*f", randInt(0, 8), std::fabs(d) < 1e30 ? d : 1.0); break;
+		default: std::snprintf(buf, sizeof buf, "%.*g", randInt(1, 16), d); break;
+		}
+		return buf;
+	}
+
+	// 乱码：数字与分隔/符号字符混排，检查结束指针和错误码
+	std::string genJunk()
+	{
+		static const char kChars[] = "0123456789012345678901234567890123456789..--++eE \t,;xnaifINF";
+		std::string s;
+		const int n = randInt(0, 14);
+		for (int i = 0; i < n; ++i) s.push_back(kChars[randInt(0, (int)sizeof(kChars) - 2)]);
+		return s;
+	}
+
+	const char* g_fixedCases[] = {
+		"0", "-0", "0.", ".0", "-.5", ".", "-", "+1", "1e", "1e+", "9007199254740992", "9007199254740993",
+		"18446744073709551615", "18446744073709551616", "0.1", "0.30000000000000004", "4512345.102",
+		"1234567890123456789", "12345678901234567890", "0.0000000000000000000001", "1e22", "1e23",
+		"inf", "nan", "-infinity", "1.7976931348623157e308", "4.9e-324", "2.2250738585072014e-308",
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const long long total = argc > 1 ? std::atoll(argv[1]) : 20000000LL;
+	const unsigned long long seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1ULL;
+	g_rng.seed(seed);
+
+	long long tested = 0, fastOk = 0, bad = 0;
+	auto check = [&](const std::string& s)
+	{
+		const char* first = s.data();
+		const char* last = first + s.size();
+		double a = -12345.0, b = -12345.0;
+		const auto ra = FastFloat::Parse(first, last, a);
+		const auto rb = std::from_chars(first, last, b);
+		++tested;
+		bool same = ra.ec == rb.ec && ra.ptr == rb.ptr;
+		if (same && rb.ec == std::errc())
+		{
+			same = std::memcmp(&a, &b, sizeof(double)) == 0;
+			++fastOk;
+		}
+		if (!same && ++bad <= 20)
+		{
+			std::uint64_t ba, bb;
+			std::memcpy(&ba, &a, 8);
+			std::memcpy(&bb, &b, 8);
+			std::printf("MISMATCH \"%s\": fast(ec=%d len=%d bits=%016" PRIx64 ") from_chars(ec=%d len=%d bits=%016" PRIx64 ")\n",
+				s.c_str(), (int)ra.ec, (int)(ra.ptr - first), ba, (int)rb.ec, (int)(rb.ptr - first), bb);
+		}
+	};
+
+	for (const char* c : g_fixedCases) check(c);
+	for (long long i = 0; i < total; ++i)
+	{
+		switch (i % 3)
+		{
+		case 0:  check(genFixed()); break;
+		case 1:  check(genPrinted()); break;
+		default: check(genJunk()); break;
+		}
+	}
+
+	std::printf("seed %llu: %lld inputs, %lld parsed, %lld mismatches\n", seed, tested, fastOk, bad);
+	return bad == 0 ? 0 : 1;
+}
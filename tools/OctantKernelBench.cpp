@@ -0,0 +1,190 @@
+// OctantKernelBench.cpp
+// 八分分类 / 包围盒的微基准（ms）：原来的逐点 Bnd_Box 循环 vs OctantKernel 标量路径 vs 运行期选用的路径（支持时为 AVX2）
+//
+// 独立程序，不在 MfcOcct.vcxproj 里。要 OCCT 头文件和 TKernel / TKMath（旧循环用 Bnd_Box）。编译（在仓库根目录）：
+//   cl /O2 /std:c++17 /EHsc /I"%CASROOT%\inc" tools\OctantKernelBench.cpp /link /LIBPATH:"%CASROOT%\win64\vc14\lib" TKernel.lib TKMath.lib
+//   g++ -O2 -std=c++17 -I$CASROOT/include/opencascade tools/OctantKernelBench.cpp -o OctantKernelBench -lTKernel -lTKMath
+// 不需要 /arch:AVX2 / -mavx2：AVX2 路径总是编译进来，由 OctantKernel::HasAVX2 在运行时选用
+// 用法：OctantKernelBench [点数=1450000] [重复次数=11] [f32]
+//   在 100 x 100 x 10 的 UTM 量级范围里生成均匀随机点；给 "f32" 时按 Float32 存储（局部原点 + float 列）
+//   每项取重复中最快的一次；三条路径的八分码、计数、子块包围盒必须一致，否则返回 1
+#include "../OctantKernel.hxx"
+#include <Bnd_Box.hxx>
+#include <gp_Pnt.hxx>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+	// 原来 Partition8Column 的统计循环：逐点算八分码，Bnd_Box::Update 累加子块包围盒
+	void classifyOld(const Column3f& pos, const int* ids, std::size_t n, const double c[3],
+		uint8_t* codes, std::size_t count[8], Bnd_Box box[8])
+	{
+		for (int k = 0; k < 8; ++k)
+		{
+			count[k] = 0;
+			box[k].SetVoid();
+		}
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			Standard_Real x, y, z;
+			pos.Get(ids[i], x, y, z);
+
+			const int oct = (x >= c[0] ? 1 : 0)
+				| (y >= c[1] ? 2 : 0)
+				| (z >= c[2] ? 4 : 0);
+			codes[i] = (uint8_t)oct;
+			++count[oct];
+			box[oct].Update(x, y, z);
+		}
+	}
+
+	// 原来 ComputeBBoxColumn 的循环：每点构造 gp_Pnt 再 Bnd_Box::Add
+	Bnd_Box boundsOld(const Column3f& pos, const int* ids, std::size_t n)
+	{
+		Bnd_Box box;
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			Standard_Real x, y, z;
+			pos.Get(ids[i], x, y, z);
+			box.Add(gp_Pnt(x, y, z));
+		}
+		return box;
+	}
+
+	template<typename F>
+	double bestMs(int repeat, F&& f)
+	{
+		double best = 1e300;
+		for (int r = 0; r < repeat; ++r)
+		{
+			const auto t0 = std::chrono::steady_clock::now();
+			f();
+			const auto t1 = std::chrono::steady_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+		}
+		return best;
+	}
+
+	// Bnd_Box 与 min / max 数组逐位比较（Bnd_Box 不加 Gap）
+	bool sameBox(const Bnd_Box& b, std::size_t count, const double lo[], const double hi[])
+	{
+		if (count == 0)
+			return b.IsVoid();
+		if (b.IsVoid())
+			return false;
+		Standard_Real v[6];
+		b.Get(v[0], v[1], v[2], v[3], v[4], v[5]);
+		for (int a = 0; a < 3; ++a)
+			if (std::memcmp(&v[a], &lo[a], sizeof(double)) != 0 || std::memcmp(&v[a + 3], &hi[a], sizeof(double)) != 0)
+				return false;
+		return true;
+	}
+
+	struct Case
+	{
+		const char*      Name;
+		std::vector<int> Ids;
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t n = argc > 1 ? (std::size_t)std::max(4L, std::atol(argv[1])) : 1450000;
+	const int repeat = argc > 2 ? std::max(1, std::atoi(argv[2])) : 11;
+	const bool f32 = argc > 3 && std::strcmp(argv[3], "f32") == 0;
+
+	std::mt19937_64 rng(1);
+	std::uniform_real_distribution<double> u(0.0, 1.0);
+	std::vector<double> x(n), y(n), z(n);
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		x[i] = 500000.0 + 100.0 * u(rng);
+		y[i] = 4500000.0 + 100.0 * u(rng);
+		z[i] = 10.0 * u(rng);
+	}
+
+	Column3f pos;
+	pos.Count = n;
+	std::vector<float> fx, fy, fz;
+	if (f32)
+	{
+		pos.Origin[0] = 500000.0; pos.Origin[1] = 4500000.0; pos.Origin[2] = 0.0;
+		fx.resize(n); fy.resize(n); fz.resize(n);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			fx[i] = (float)(x[i] - pos.Origin[0]);
+			fy[i] = (float)(y[i] - pos.Origin[1]);
+			fz[i] = (float)(z[i] - pos.Origin[2]);
+		}
+		pos.FX = fx.data(); pos.FY = fy.data(); pos.FZ = fz.data();
+	}
+	else
+	{
+		pos.X = x.data(); pos.Y = y.data(); pos.Z = z.data();
+	}
+
+	// 三种下标：根节点（连续）、划分后的子块（升序有间隔）、未重排的乱序
+	Case cases[3] = { { "sequential", {} }, { "gapped", {} }, { "shuffled", {} } };
+	cases[0].Ids.resize(n);
+	std::iota(cases[0].Ids.begin(), cases[0].Ids.end(), 0);
+	for (std::size_t i = 0; i < n; ++i)
+		if (x[i] >= 500050.0)
+			cases[1].Ids.push_back((int)i);
+	cases[2].Ids = cases[0].Ids;
+	std::shuffle(cases[2].Ids.begin(), cases[2].Ids.end(), rng);
+
+	const double c[3] = { 500050.0, 4500050.0, 5.0 };
+	std::vector<uint8_t> codesOld(n), codesScalar(n), codesKernel(n);
+
+	std::printf("%zu points, %s storage, AVX2 %s, best of %d\n",
+		n, f32 ? "float32" : "double", OctantKernel::HasAVX2() ? "yes" : "no", repeat);
+	std::printf("%-22s %10s %10s %10s\n", "", "old", "scalar", "kernel");
+
+	int bad = 0;
+	for (const Case& cs : cases)
+	{
+		const int* ids = cs.Ids.data();
+		const std::size_t m = cs.Ids.size();
+
+		std::size_t count[8];
+		Bnd_Box box[8];
+		OctantStats sScalar, sKernel;
+		const double tOld = bestMs(repeat, [&] { classifyOld(pos, ids, m, c, codesOld.data(), count, box); });
+		const double tScalar = bestMs(repeat, [&] { sScalar.Reset(); OctantKernel::ClassifyScalar(pos, ids, m, c, codesScalar.data(), sScalar); });
+		const double tKernel = bestMs(repeat, [&] { sKernel.Reset(); OctantKernel::Classify(pos, ids, m, c, codesKernel.data(), sKernel); });
+
+		bool ok = std::equal(codesOld.begin(), codesOld.begin() + m, codesScalar.begin())
+			&& std::equal(codesOld.begin(), codesOld.begin() + m, codesKernel.begin());
+		for (int k = 0; k < 8; ++k)
+		{
+			ok = ok && count[k] == sScalar.Count[k] && count[k] == sKernel.Count[k]
+				&& sameBox(box[k], count[k], sScalar.Min[k], sScalar.Max[k])
+				&& sameBox(box[k], count[k], sKernel.Min[k], sKernel.Max[k]);
+		}
+
+		double lo[2][3], hi[2][3];
+		Bnd_Box bOld;
+		const double bTOld = bestMs(repeat, [&] { bOld = boundsOld(pos, ids, m); });
+		const double bTScalar = bestMs(repeat, [&] {
+			std::fill(lo[0], lo[0] + 3, std::numeric_limits<double>::infinity());
+			std::fill(hi[0], hi[0] + 3, -std::numeric_limits<double>::infinity());
+			OctantKernel::BoundsScalar(pos, ids, m, lo[0], hi[0]); });
+		const double bTKernel = bestMs(repeat, [&] {
+			std::fill(lo[1], lo[1] + 3, std::numeric_limits<double>::infinity());
+			std::fill(hi[1], hi[1] + 3, -std::numeric_limits<double>::infinity());
+			OctantKernel::Bounds(pos, ids, m, lo[1], hi[1]); });
+		ok = ok && sameBox(bOld, m, lo[0], hi[0]) && sameBox(bOld, m, lo[1], hi[1]);
+
+		std::printf("classify %-13s %10.2f %10.2f %10.2f%s\n", cs.Name, tOld, tScalar, tKernel, ok ? "" : "  MISMATCH");
+		std::printf("bounds   %-13s %10.2f %10.2f %10.2f\n", cs.Name, bTOld, bTScalar, bTKernel);
+		bad += ok ? 0 : 1;
+	}
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,332 @@
+// TileBuildBench.cpp
+// tile 树构建的多线程扩展性基准：同一份点云按给定线程数依次跑 CloudTilingColumns::Build（划分方式可选）和 BuildLODsForTiles，
+// 报墙钟时间和相对 1 线程的加速比（LOD 一步每次都从 1 线程建出的同一棵树开始）
+// 每个线程数先测一遍多线程顺序读 Position 列的带宽，作为这台机器上划分能达到的上限参考：
+// "bw bound" 列 = 该线程数的读带宽 / 1 线程的读带宽，即只受内存带宽限制时加速比的上限
+// 每种划分方式另报一行叶子点数的均衡度（个数 / 最少 / 最多 / 变异系数 / 不到 LeafMaxPoints / 8 的小叶子数），用来对比八叉与 KD
+//
+// 独立程序，不在 MfcOcct.vcxproj 里。要 OCCT 头文件和库。编译（在仓库根目录）：
+//   cl /O2 /std:c++17 /EHsc /I"%CASROOT%\inc" tools\TileBuildBench.cpp CloudTilingColumns.cxx /link /LIBPATH:"%CASROOT%\win64\vc14\lib" TKernel.lib TKMath.lib TKService.lib TKV3d.lib
+//   g++ -O2 -std=c++17 -pthread -I$CASROOT/include/opencascade tools/TileBuildBench.cpp CloudTilingColumns.cxx -o TileBuildBench -lTKernel -lTKMath -lTKService -lTKV3d
+// 用法：TileBuildBench [点数=200000000] [线程数=1,8,16,32] [重复次数=3] [选项...]
+//   选项：octree / kd / morton 选划分方式，可给多个、依次测（默认 octree）；f32；corridor
+//   只有八叉划分是多线程的，KD / Morton 的划分时间不随线程数变，LOD 一步照样按线程数并行
+//   点云是合成的：大范围起伏地面 + 若干高密度团块（与实测扫描一样疏密不均），按固定种子分块生成，与线程数无关；
+//   给 "corridor" 时改为 400 m x 3 m x 3 m 走廊的地面、顶面和两侧墙面（狭长扫描，八叉叶子大小悬殊的情形）
+//   double 存储 2 亿点约需 4.8 GB 坐标 + 1.8 GB 划分缓冲；给 "f32" 时按 Float32 存储，坐标减半
+//   每项取重复中最快的一次；各线程数建出的 tile 和各级 LOD 必须与 1 线程逐个相同，否则返回 1
+#include "../CloudTilingColumns.hxx"
+#include "../ColumnTileLOD.hxx"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	using clk = std::chrono::steady_clock;
+
+	double msSince(clk::time_point t0)
+	{
+		return std::chrono::duration<double, std::milli>(clk::now() - t0).count();
+	}
+
+	// 合成点云：80% 地面（1 km x 1 km，起伏 ±20 m），20% 落在 16 个半径约 5 m 的团块里；
+	// corridor 时是 400 x 3 x 3 m 走廊的四个面，点在面上均匀分布，法向上加 1 cm 噪声
+	// 每 1M 点一块，块内用块号做种子，结果与生成时的线程数无关
+	void generate(std::size_t n, int threads, bool corridor, std::vector<double>& x, std::vector<double>& y, std::vector<double>& z)
+	{
+		x.resize(n); y.resize(n); z.resize(n);
+		const std::size_t kBlock = 1u << 20;
+		const std::size_t nBlocks = (n + kBlock - 1) / kBlock;
+
+		double blob[16][3];
+		std::mt19937_64 g(12345);
+		std::uniform_real_distribution<double> u(0.0, 1000.0);
+		for (auto& b : blob) { b[0] = u(g); b[1] = u(g); b[2] = 0.0; }
+
+		std::atomic<std::size_t> next{ 0 };
+		RunOnThreads(threads, [&](int) {
+			for (std::size_t b; (b = next.fetch_add(1)) < nBlocks; )
+			{
+				std::mt19937_64 rng(b + 1);
+				std::uniform_real_distribution<double> u01(0.0, 1.0);
+				std::normal_distribution<double> nrm(0.0, 2.5);
+				for (std::size_t i = b * kBlock, e = std::min(n, i + kBlock); i < e; ++i)
+				{
+					double px, py;
+					if (corridor)
+					{
+						// 四个面各占 1/4：地面、顶面、左墙、右墙；t 是面内横向位置，e 是法向噪声
+						const int face = (int)(rng() & 3);
+						const double t = 3.0 * u01(rng);
+						const double e = 0.004 * nrm(rng);
+						x[i] = 500000.0 + 400.0 * u01(rng);
+						y[i] = 4500000.0 + (face < 2 ? t : (face == 2 ? e : 3.0 + e));
+						z[i] = face < 2 ? (face == 0 ? e : 3.0 + e) : t;
+						continue;
+					}
+					if (u01(rng) < 0.8)
+					{
+						px = 1000.0 * u01(rng);
+						py = 1000.0 * u01(rng);
+					}
+					else
+					{
+						const double* c = blob[rng() & 15];
+						px = c[0] + nrm(rng);
+						py = c[1] + nrm(rng);
+					}
+					x[i] = 500000.0 + px;
+					y[i] = 4500000.0 + py;
+					z[i] = 20.0 * std::sin(px * 0.01) * std::cos(py * 0.013) + 0.05 * nrm(rng);
+				}
+			}
+		});
+	}
+
+	// threads 个线程各顺序读 Position 列的一段并求和，返回 GB/s
+	double readBandwidth(const Column3f& pos, int threads)
+	{
+		const std::size_t n = pos.Count;
+		std::vector<double> sums((std::size_t)threads * 8, 0.0);   // 各占一条缓存行
+		const auto t0 = clk::now();
+		RunOnThreads(threads, [&](int t) {
+			const std::size_t b = n * (std::size_t)t / (std::size_t)threads;
+			const std::size_t e = n * (std::size_t)(t + 1) / (std::size_t)threads;
+			double s = 0.0;
+			if (pos.X)
+				for (std::size_t i = b; i < e; ++i) s += pos.X[i] + pos.Y[i] + pos.Z[i];
+			else
+				for (std::size_t i = b; i < e; ++i) s += (double)pos.FX[i] + pos.FY[i] + pos.FZ[i];
+			sums[(std::size_t)t * 8] = s;
+		});
+		const double sec = msSince(t0) * 1e-3;
+		volatile double sink = 0.0;
+		for (double s : sums) sink = sink + s;
+		const double bytes = (double)n * 3.0 * (pos.X ? sizeof(double) : sizeof(float));
+		return bytes / sec * 1e-9;
+	}
+
+	// tile 树的划分结果逐个比较（层级、区间、叶子点集）
+	bool sameTiles(const std::vector<ColumnTile>& a, const std::vector<ColumnTile>& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		std::vector<int> sa, sb;
+		for (std::size_t i = 0; i < a.size(); ++i)
+		{
+			if (a[i].Depth != b[i].Depth || a[i].Parent != b[i].Parent || a[i].Children != b[i].Children
+				|| a[i].OrderOffset != b[i].OrderOffset || a[i].OrderCount != b[i].OrderCount
+				|| a[i].ExpandIndices(sa) != b[i].ExpandIndices(sb))
+				return false;
+		}
+		return true;
+	}
+
+	// 各级 LOD 逐个比较（点序、点数、误差）
+	bool sameLODs(const std::vector<ColumnTile>& a, const std::vector<ColumnTile>& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		std::vector<int> sa, sb;
+		for (std::size_t i = 0; i < a.size(); ++i)
+		{
+			if (a[i].LODs.size() != b[i].LODs.size())
+				return false;
+			for (std::size_t k = 0; k < a[i].LODs.size(); ++k)
+			{
+				const TileLODLevel& la = a[i].LODs[k];
+				const TileLODLevel& lb = b[i].LODs[k];
+				if (la.PointCount != lb.PointCount || la.ErrorWorld != lb.ErrorWorld
+					|| la.ExpandIndices(sa) != lb.ExpandIndices(sb))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// 叶子点数的均衡度
+	struct LeafBalance
+	{
+		std::size_t Leaves = 0, Min = 0, Max = 0, Small = 0;
+		double      CV = 0.0;   // 标准差 / 均值
+	};
+
+	LeafBalance leafBalance(const std::vector<ColumnTile>& tiles, int leafMaxPoints)
+	{
+		LeafBalance b;
+		double sum = 0.0, sum2 = 0.0;
+		for (const ColumnTile& t : tiles)
+		{
+			if (!t.Children.empty()) continue;
+			const std::size_t c = t.NumPoints();
+			b.Min = b.Leaves == 0 ? c : std::min(b.Min, c);
+			b.Max = std::max(b.Max, c);
+			b.Small += c < (std::size_t)leafMaxPoints / 8 ? 1 : 0;
+			++b.Leaves;
+			sum += (double)c;
+			sum2 += (double)c * (double)c;
+		}
+		if (b.Leaves > 0 && sum > 0.0)
+		{
+			const double mean = sum / (double)b.Leaves;
+			b.CV = std::sqrt(std::max(0.0, sum2 / (double)b.Leaves - mean * mean)) / mean;
+		}
+		return b;
+	}
+
+	const char* schemeName(TilingScheme s)
+	{
+		return s == TilingScheme::KDTree ? "kd" : (s == TilingScheme::Morton ? "morton" : "octree");
+	}
+
+	std::vector<int> parseThreads(const char* s)
+	{
+		std::vector<int> out;
+		std::stringstream ss(s);
+		std::string item;
+		while (std::getline(ss, item, ','))
+		{
+			const int t = std::atoi(item.c_str());
+			if (t > 0) out.push_back(t);
+		}
+		return out;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t n = argc > 1 ? (std::size_t)std::max(1000.0, std::atof(argv[1])) : 200000000;
+	std::vector<int> threadList = parseThreads(argc > 2 ? argv[2] : "1,8,16,32");
+	const int repeat = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+	bool f32 = false, corridor = false;
+	std::vector<TilingScheme> schemes;
+	for (int a = 4; a < argc; ++a)
+	{
+		if (std::strcmp(argv[a], "f32") == 0) f32 = true;
+		else if (std::strcmp(argv[a], "corridor") == 0) corridor = true;
+		else if (std::strcmp(argv[a], "octree") == 0) schemes.push_back(TilingScheme::Octree);
+		else if (std::strcmp(argv[a], "kd") == 0) schemes.push_back(TilingScheme::KDTree);
+		else if (std::strcmp(argv[a], "morton") == 0) schemes.push_back(TilingScheme::Morton);
+		else
+		{
+			std::fprintf(stderr, "unknown option: %s\n", argv[a]);
+			return 2;
+		}
+	}
+	if (schemes.empty())
+		schemes.push_back(TilingScheme::Octree);
+	if (threadList.empty() || threadList.front() != 1)
+		threadList.insert(threadList.begin(), 1);   // 加速比以 1 线程为基准
+
+	const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+	std::printf("%zu points (%s), %s storage, %u hardware threads, best of %d\n",
+		n, corridor ? "corridor" : "terrain", f32 ? "float32" : "double", hw, repeat);
+
+	std::vector<double> x, y, z;
+	std::vector<float> fx, fy, fz;
+	auto t0 = clk::now();
+	generate(n, (int)hw, corridor, x, y, z);
+
+	CloudColumns columns;
+	Column3f& pos = columns.Position;
+	pos.Count = n;
+	if (f32)
+	{
+		pos.Origin[0] = 500000.0; pos.Origin[1] = 4500000.0; pos.Origin[2] = 0.0;
+		fx.resize(n); fy.resize(n); fz.resize(n);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			fx[i] = (float)(x[i] - pos.Origin[0]);
+			fy[i] = (float)(y[i] - pos.Origin[1]);
+			fz[i] = (float)(z[i] - pos.Origin[2]);
+		}
+		std::vector<double>().swap(x); std::vector<double>().swap(y); std::vector<double>().swap(z);
+		pos.FX = fx.data(); pos.FY = fy.data(); pos.FZ = fz.data();
+	}
+	else
+	{
+		pos.X = x.data(); pos.Y = y.data(); pos.Z = z.data();
+	}
+	std::printf("generated in %.0f ms\n\n", msSince(t0));
+
+	const int maxLODLevel = 2;
+	int bad = 0;
+	for (TilingScheme scheme : schemes)
+	{
+		TilingParams params;
+		params.Scheme = scheme;
+
+		std::vector<ColumnTile> reference, lodReference;
+		double base = 0.0, lodBase = 0.0, bwBase = 0.0;
+
+		std::printf("%s\n%8s %10s %9s %12s %9s %10s %9s %8s\n", schemeName(scheme),
+			"threads", "read GB/s", "bw bound", "build ms", "speedup", "LOD ms", "speedup", "tiles");
+		for (int t : threadList)
+		{
+			double bw = 0.0;
+			for (int r = 0; r < repeat; ++r)
+				bw = std::max(bw, readBandwidth(pos, t));
+			if (t == 1)
+				bwBase = bw;
+
+			params.Threads = t;
+			double best = 1e300;
+			std::vector<ColumnTile> tiles;
+			for (int r = 0; r < repeat; ++r)
+			{
+				tiles.clear();
+				tiles.shrink_to_fit();
+				TilingStatsColumns stats;
+				t0 = clk::now();
+				CloudTilingColumns::Build(columns, tiles, stats, params);
+				best = std::min(best, msSince(t0));
+			}
+
+			bool ok = true;
+			if (t == 1)
+			{
+				base = best;
+				reference = std::move(tiles);
+			}
+			else
+				ok = sameTiles(reference, tiles);
+
+			// LOD：每次拷一份 1 线程的树（拷贝不计时），叶子和内部节点都建到 maxLODLevel
+			double lodBest = 1e300;
+			std::vector<ColumnTile> lodTiles;
+			for (int r = 0; r < repeat; ++r)
+			{
+				lodTiles = reference;
+				t0 = clk::now();
+				BuildLODsForTiles(columns, lodTiles, maxLODLevel, nullptr, false, t);
+				lodBest = std::min(lodBest, msSince(t0));
+			}
+			if (t == 1)
+			{
+				lodBase = lodBest;
+				lodReference = std::move(lodTiles);
+			}
+			else
+				ok = ok && sameLODs(lodReference, lodTiles);
+
+			std::printf("%8d %10.2f %8.2fx %12.0f %8.2fx %10.0f %8.2fx %8zu%s%s\n", t, bw, bw / bwBase, best, base / best,
+				lodBest, lodBase / lodBest, reference.size(),
+				(unsigned)t > hw ? "  (more threads than cores)" : "", ok ? "" : "  MISMATCH");
+			bad += ok ? 0 : 1;
+		}
+
+		const LeafBalance lb = leafBalance(reference, params.LeafMaxPoints);
+		std::printf("leaves %zu, points per leaf min %zu max %zu, CV %.2f, %zu under %d\n\n",
+			lb.Leaves, lb.Min, lb.Max, lb.CV, lb.Small, params.LeafMaxPoints / 8);
+	}
+	return bad ? 1 : 0;
+}
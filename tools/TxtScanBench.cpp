@@ -0,0 +1,183 @@
+// TxtScanBench.cpp
+// 文本解析的吞吐微基准（bytes/s）：原来的逐字节循环 vs TxtScan 扫描内核 + FastFloat
+//
+// 独立程序，不在 MfcOcct.vcxproj 里。编译（在仓库根目录）：
+//   cl /O2 /std:c++17 /EHsc tools\TxtScanBench.cpp                (SSE2)
+//   cl /O2 /std:c++17 /EHsc /arch:AVX2 tools\TxtScanBench.cpp     (AVX2)
+//   g++ -O2 -std=c++17 [-mavx2] tools/TxtScanBench.cpp -o TxtScanBench
+// 用法：TxtScanBench [文件] [重复次数]
+//   不给文件（或给 "-"）时生成 1M 行 "x y z nx ny nz" 的合成数据；每项取重复中最快的一次
+// 两种解析循环的点数和数值校验和必须一致，否则返回 1
+#include "../TxtScan.hxx"
+#include "../FastFloat.hxx"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+	struct ParseSum
+	{
+		std::size_t Lines = 0;
+		std::size_t Values = 0;
+		double      Sum = 0.0;
+	};
+
+	// 原来的做法：先整文件数一遍 '\n' 供 reserve，再逐字节走一遍，字段用 from_chars
+	ParseSum parseOld(const char* beg, const char* end)
+	{
+		ParseSum r;
+		std::size_t nLines = 0;
+		for (const char* q = beg; q < end; ++q) if (*q == '\n') ++nLines;
+		volatile std::size_t reserveHint = nLines;   // 原代码用它 reserve，这里只保证不被优化掉
+		(void)reserveHint;
+
+		const char* ptr = beg;
+		while (ptr < end)
+		{
+			int col = 0;
+			for (;;)
+			{
+				if (ptr >= end || *ptr == '\n') { if (ptr < end) ++ptr; break; }
+				if (*ptr == '\r') { ++ptr; if (ptr < end && *ptr == '\n') ++ptr; break; }
+				while (ptr < end && (*ptr == ' ' || *ptr == '\t')) ++ptr;
+				if (ptr >= end || *ptr == '\n') { if (ptr < end) ++ptr; break; }
+				if (*ptr == '\r') { ++ptr; if (ptr < end && *ptr == '\n') ++ptr; break; }
+
+				double v;
+				auto res = std::from_chars(ptr, end, v);
+				if (res.ec != std::errc()) {
+					while (ptr < end && *ptr != ' ' && *ptr != '\t' && *ptr != '\n' && *ptr != '\r') ++ptr;
+					continue;
+				}
+				r.Sum += v;
+				++col;
+				ptr = res.ptr;
+			}
+			if (col > 0) { ++r.Lines; r.Values += (std::size_t)col; }
+		}
+		return r;
+	}
+
+	// 现在的做法（同 CloudDataStore 的 parseLineFloats）：采样估行数，每行只找一次行尾，字段限定在本行内切分
+	ParseSum parseNew(const char* beg, const char* end)
+	{
+		ParseSum r;
+		volatile std::size_t reserveHint = TxtScan::EstimateLines(beg, end);
+		(void)reserveHint;
+
+		const char* ptr = beg;
+		while (ptr < end)
+		{
+			const char* eol = TxtScan::FindEOL(ptr, end);
+			int col = 0;
+			for (const char* p = ptr;;)
+			{
+				p = TxtScan::SkipBlanks(p, eol);
+				if (p >= eol) break;
+				double v;
+				auto res = FastFloat::Parse(p, eol, v);
+				if (res.ec != std::errc()) {
+					p = TxtScan::FindDelim(p, eol);
+					continue;
+				}
+				r.Sum += v;
+				++col;
+				p = res.ptr;
+			}
+			if (col > 0) { ++r.Lines; r.Values += (std::size_t)col; }
+
+			ptr = eol;
+			if (ptr < end && *ptr == '\r') ++ptr;
+			if (ptr < end && *ptr == '\n') ++ptr;
+		}
+		return r;
+	}
+
+	std::size_t countOld(const char* beg, const char* end)
+	{
+		std::size_t n = 0;
+		for (const char* q = beg; q < end; ++q) if (*q == '\n') ++n;
+		return n;
+	}
+
+	template <class F>
+	double bestMs(int repeat, F&& fn)
+	{
+		double best = 1e300;
+		for (int i = 0; i < repeat; ++i)
+		{
+			const auto t0 = std::chrono::steady_clock::now();
+			fn();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+		}
+		return best;
+	}
+
+	std::string synthesize(std::size_t lines)
+	{
+		std::mt19937_64 rng(12345);
+		std::uniform_real_distribution<double> pos(0.0, 1000.0), nrm(-1.0, 1.0);
+		std::string s;
+		s.reserve(lines * 64);
+		char buf[160];
+		for (std::size_t i = 0; i < lines; ++i)
+		{
+			const int n = std::snprintf(buf, sizeof(buf), "%.3f %.3f %.3f %.6f %.6f %.6f\n",
+				pos(rng), pos(rng), pos(rng), nrm(rng), nrm(rng), nrm(rng));
+			s.append(buf, (std::size_t)n);
+		}
+		return s;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string text;
+	if (argc > 1 && std::strcmp(argv[1], "-") != 0)
+	{
+		std::ifstream in(argv[1], std::ios::binary);
+		if (!in) { std::fprintf(stderr, "cannot open %s\n", argv[1]); return 2; }
+		std::ostringstream ss;
+		ss << in.rdbuf();
+		text = ss.str();
+	}
+	else
+		text = synthesize(1000000);
+	const int repeat = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+	const char* beg = text.data();
+	const char* end = beg + text.size();
+	const double mb = (double)text.size() / (1024.0 * 1024.0);
+
+#if TXTSCAN_AVX2
+	const char* path = "AVX2";
+#elif TXTSCAN_SSE2
+	const char* path = "SSE2";
+#else
+	const char* path = "scalar";
+#endif
+	std::printf("input %.1f MB, kernel path %s, best of %d\n", mb, path, repeat);
+
+	volatile std::size_t sink = 0;
+	const double cOld = bestMs(repeat, [&] { sink = countOld(beg, end); });
+	const double cNew = bestMs(repeat, [&] { sink = TxtScan::CountNewlines(beg, end); });
+	const bool countSame = countOld(beg, end) == TxtScan::CountNewlines(beg, end);
+	std::printf("newline count : old %8.1f MB/s  new %8.1f MB/s  (%.2fx)  same=%d\n",
+		mb / cOld * 1000.0, mb / cNew * 1000.0, cOld / cNew, (int)countSame);
+
+	ParseSum a, b;
+	const double pOld = bestMs(repeat, [&] { a = parseOld(beg, end); });
+	const double pNew = bestMs(repeat, [&] { b = parseNew(beg, end); });
+	const bool parseSame = a.Lines == b.Lines && a.Values == b.Values && std::memcmp(&a.Sum, &b.Sum, sizeof(double)) == 0;
+	std::printf("scan + parse  : old %8.1f MB/s  new %8.1f MB/s  (%.2fx)  lines=%zu values=%zu same=%d\n",
+		mb / pOld * 1000.0, mb / pNew * 1000.0, pOld / pNew, b.Lines, b.Values, (int)parseSame);
+
+	return countSame && parseSame ? 0 : 1;
+}